@@ -39,6 +39,7 @@
 #include <QDebug>
 #include <QPointer>
 #include <QIcon>
+#include <QPainter>
 #include <map>
 
 #include "DockAreaTitleBar_p.h"
@@ -53,6 +54,7 @@
 #include "DockAreaTabBar.h"
 #include "IconProvider.h"
 #include "DockComponentsFactory.h"
+#include "DockMetrics.h"
 
 #include <iostream>
 
@@ -647,6 +649,23 @@ void CDockAreaTitleBar::setVisible(bool Visible)
 }
 
 
+//============================================================================
+void CDockAreaTitleBar::paintEvent(QPaintEvent* ev)
+{
+	Super::paintEvent(ev);
+	// Painted replacement for the focused title bar rule of the focus
+	// highlighting style sheet - a two pixel highlight line at the bottom
+	if (!CDockManager::testConfigFlag(CDockManager::PaintedFocusHighlighting)
+	 || !d->DockArea->property("focused").toBool())
+	{
+		return;
+	}
+
+	QPainter Painter(this);
+	Painter.fillRect(0, height() - 2, width(), 2, palette().color(QPalette::Highlight));
+}
+
+
 //============================================================================
 void CDockAreaTitleBar::mousePressEvent(QMouseEvent* ev)
 {
@@ -1041,6 +1060,7 @@ bool CTitleBarStateButton::event(QEvent* ev)
 CSpacerWidget::CSpacerWidget(QWidget* Parent /*= 0*/) : Super(Parent)
 {
 	setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+	CDockMetrics::increment(StyleSheetSets);
 	setStyleSheet("border: none; background: none;");
 }
 
@@ -58,6 +58,8 @@
 #include "DockAreaTitleBar.h"
 #include "DockComponentsFactory.h"
 #include "DockWidgetTab.h"
+#include "DockTrace.h"
+#include "DockMetrics.h"
 
 
 namespace ads
@@ -257,12 +259,39 @@ struct DockAreaWidgetPrivate
 	DockWidgetAreas		AllowedAreas	= DefaultAllowedAreas;
 	QSize MinSizeHint;
 	CDockAreaWidget::DockAreaFlags Flags{CDockAreaWidget::DefaultFlags};
+	QList<CDockWidget*> OpenedDockWidgets;
+	bool OpenedDockWidgetsValid = false;
+	QColor BorderColor;///< border color of the current dock widget
 
 	/**
 	 * Private data constructor
 	 */
 	DockAreaWidgetPrivate(CDockAreaWidget* _public);
 
+	/**
+	 * Returns the cached list of opened dock widgets. The list is rebuilt
+	 * if dock widgets have been added, removed, moved, opened or closed
+	 * since the last call.
+	 */
+	const QList<CDockWidget*>& openedDockWidgets()
+	{
+		if (!OpenedDockWidgetsValid)
+		{
+			OpenedDockWidgets.clear();
+			for (int i = 0; i < ContentsLayout->count(); ++i)
+			{
+				CDockWidget* DockWidget = dockWidgetAt(i);
+				if (!DockWidget->isClosed())
+				{
+					OpenedDockWidgets.append(DockWidget);
+				}
+			}
+			OpenedDockWidgetsValid = true;
+		}
+
+		return OpenedDockWidgets;
+	}
+
 	/**
 	 * Creates the layout for top area with tabs and close button
 	 */
@@ -404,7 +433,14 @@ void CDockAreaWidget::update() {
 	if (val == nullptr)
 		return;
 
-	this->setStyleSheet("ads--CDockAreaWidget{ border-color: " + val->get_border_color() + ";}");
+	// The border is drawn in paintEvent(). A style sheet would force Qt to
+	// re-polish the complete dock area including its content widgets.
+	QColor BorderColor(val->get_border_color());
+	if (BorderColor == d->BorderColor)
+		return;
+
+	d->BorderColor = BorderColor;
+	Super::update();
 }
 
 //============================================================================
@@ -434,7 +470,9 @@ void CDockAreaWidget::addDockWidget(CDockWidget* DockWidget)
 void CDockAreaWidget::insertDockWidget(int index, CDockWidget* DockWidget,
 	bool Activate)
 {
+	ADS_TRACE_SCOPE("CDockAreaWidget::insertDockWidget");
 	d->ContentsLayout->insertWidget(index, DockWidget);
+	invalidateOpenedDockWidgets();
 	DockWidget->setDockArea(this);
 	DockWidget->tabWidget()->setDockAreaWidget(this);
 	auto TabWidget = DockWidget->tabWidget();
@@ -459,7 +497,7 @@ void CDockAreaWidget::insertDockWidget(int index, CDockWidget* DockWidget,
 	}
 	d->updateTitleBarButtonStates();
 	updateTitleBarVisibility();
-	this->setStyleSheet("ads--CDockAreaWidget{ border-color: " + currentDockWidget()->get_border_color() + ";}");
+	update();
 }
 
 
@@ -471,6 +509,7 @@ void CDockAreaWidget::removeDockWidget(CDockWidget* DockWidget)
   	auto NextOpenDockWidget = (DockWidget == CurrentDockWidget) ? nextOpenDockWidget(DockWidget) : nullptr;
 
 	d->ContentsLayout->removeWidget(DockWidget);
+	invalidateOpenedDockWidgets();
 
 	auto TabWidget = DockWidget->tabWidget();
 	TabWidget->hide();
@@ -486,13 +525,13 @@ void CDockAreaWidget::removeDockWidget(CDockWidget* DockWidget)
 	{
         ADS_PRINT("Dock Area empty");
 		DockContainer->removeDockArea(this);
-		this->deleteLater();
+		internal::deleteLater(this);
 		if(DockContainer->dockAreaCount() == 0)
 		{
 			if(CFloatingDockContainer*  FloatingDockContainer = DockContainer->floatingWidget())
 			{
 				FloatingDockContainer->hide();
-				FloatingDockContainer->deleteLater();
+				internal::deleteLater(FloatingDockContainer);
 			}
 		}
 	}
@@ -519,6 +558,23 @@ void CDockAreaWidget::removeDockWidget(CDockWidget* DockWidget)
 }
 
 
+//============================================================================
+void CDockAreaWidget::releaseDockWidget(CDockWidget* DockWidget)
+{
+	// In contrast to removeDockWidget() this function never removes or
+	// hides the dock area. It is used when a layout is applied incrementally
+	// and the caller takes care of the dock area life time.
+	d->ContentsLayout->removeWidget(DockWidget);
+	invalidateOpenedDockWidgets();
+	auto TabWidget = DockWidget->tabWidget();
+	TabWidget->hide();
+	d->tabBar()->removeTab(TabWidget);
+	TabWidget->setParent(DockWidget);
+	DockWidget->setDockArea(nullptr);
+	d->updateMinimumSizeHint();
+}
+
+
 //============================================================================
 void CDockAreaWidget::hideAreaWithNoVisibleContent()
 {
@@ -686,6 +742,7 @@ void CDockAreaWidget::internalSetCurrentDockWidget(CDockWidget* DockWidget)
 //============================================================================
 void CDockAreaWidget::setCurrentIndex(int index)
 {
+	ADS_TRACE_SCOPE("CDockAreaWidget::setCurrentIndex");
 	auto TabBar = d->tabBar();
 	if (index < 0 || index > (TabBar->count() - 1))
 	{
@@ -705,7 +762,7 @@ void CDockAreaWidget::setCurrentIndex(int index)
 	d->ContentsLayout->setCurrentIndex(index);
 	d->ContentsLayout->currentWidget()->show();
 	emit currentChanged(index);
-	this->setStyleSheet("ads--CDockAreaWidget{ border-color: " + currentDockWidget()->get_border_color() + ";}");
+	update();
 }
 
 
@@ -751,31 +808,22 @@ QList<CDockWidget*> CDockAreaWidget::dockWidgets() const
 //============================================================================
 int CDockAreaWidget::openDockWidgetsCount() const
 {
-	int Count = 0;
-	for (int i = 0; i < d->ContentsLayout->count(); ++i)
-	{
-		if (!dockWidget(i)->isClosed())
-		{
-			++Count;
-		}
-	}
-	return Count;
+	return d->openedDockWidgets().count();
 }
 
 
 //============================================================================
 QList<CDockWidget*> CDockAreaWidget::openedDockWidgets() const
 {
-	QList<CDockWidget*> DockWidgetList;
-	for (int i = 0; i < d->ContentsLayout->count(); ++i)
-	{
-		CDockWidget* DockWidget = dockWidget(i);
-		if (!DockWidget->isClosed())
-		{
-			DockWidgetList.append(dockWidget(i));
-		}
-	}
-	return DockWidgetList;
+	// Returning the cached list is cheap because of implicit sharing
+	return d->openedDockWidgets();
+}
+
+
+//============================================================================
+void CDockAreaWidget::invalidateOpenedDockWidgets()
+{
+	d->OpenedDockWidgetsValid = false;
 }
 
 
@@ -822,6 +870,7 @@ void CDockAreaWidget::reorderDockWidget(int fromIndex, int toIndex)
 	auto Widget = d->ContentsLayout->widget(fromIndex);
 	d->ContentsLayout->removeWidget(Widget);
 	d->ContentsLayout->insertWidget(toIndex, Widget);
+	invalidateOpenedDockWidgets();
 	setCurrentIndex(toIndex);
 }
 
@@ -831,6 +880,7 @@ void CDockAreaWidget::toggleDockWidgetView(CDockWidget* DockWidget, bool Open)
 {
 	Q_UNUSED(DockWidget);
 	Q_UNUSED(Open);
+	invalidateOpenedDockWidgets();
 	updateTitleBarVisibility();
 }
 
@@ -839,7 +889,7 @@ void CDockAreaWidget::toggleDockWidgetView(CDockWidget* DockWidget, bool Open)
 void CDockAreaWidget::updateTitleBarVisibility()
 {
 	CDockContainerWidget* Container = dockContainer();
-	if (!Container)
+	if (!Container || dockManager()->isLayoutUpdating())
 	{
 		return;
 	}
@@ -1082,6 +1132,20 @@ void CDockAreaWidget::onDockWidgetFeaturesChanged()
 void CDockAreaWidget::paintEvent(QPaintEvent*)
 {
 	QPainter painter(this);
+	auto CurrentDockWidget = currentDockWidget();
+	if (!CurrentDockWidget)
+	{
+		return;
+	}
+
+	// Draw the border of the current dock widget over the border from the
+	// style sheet. An invalid color keeps the style sheet border.
+	if (d->BorderColor.isValid())
+	{
+		painter.setPen(d->BorderColor);
+		painter.drawRect(rect().adjusted(0, 0, -1, -1));
+	}
+
 	QPainterPath path;
 
 	auto one = 0.5;// * screen()->devicePixelRatio();
@@ -1101,7 +1165,7 @@ void CDockAreaWidget::paintEvent(QPaintEvent*)
 
 	QPen pen;
 	pen.setWidthF(0.5);
-	pen.setColor(currentDockWidget()->get_tab_color());
+	pen.setColor(CurrentDockWidget->get_tab_color());
 	painter.setPen(pen);
 	painter.drawPath(path);
 	//painter.drawRect(this->rect().x(), this->rect().y(), this->rect().width() - 1, this->rect().height() - 1);
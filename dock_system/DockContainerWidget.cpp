@@ -39,6 +39,8 @@
 #include <QXmlStreamWriter>
 #include <QAbstractButton>
 #include <QApplication>
+#include <QSet>
+#include <QTimer>
 
 #include "DockManager.h"
 #include "DockAreaWidget.h"
@@ -48,7 +50,11 @@
 #include "DockOverlay.h"
 #include "ads_globals.h"
 #include "DockSplitter.h"
+#include "DockStateSerializer.h"
+#include "DockTrace.h"
+#include "DockMetrics.h"
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
 
@@ -123,32 +129,34 @@ static void insertWidgetIntoSplitter(QSplitter* Splitter, QWidget* widget, bool
 }
 
 
-void refresh(QWidget* window) {
-
-	if (CDockManager::testConfigFlag(CDockManager::CustomFloatingTitlebar))
-		return;
-
-	ADS_PRINT(u8"ǿˢ");
+/**
+ * Bookkeeping data for the incremental restore of a dock container.
+ * It records the splitters and dock areas of the current layout and the
+ * ones that have been reused for the new layout.
+ */
+struct LayoutReuseContext
+{
+	QSet<CDockAreaWidget*> OldDockAreas;
+	QSet<QSplitter*> OldSplitters;
+	QHash<int, CDockAreaWidget*> AreaForNode;///< area node index -> reused area
+	QSet<QSplitter*> UsedSplitters;
+};
 
-	window->activateWindow();
 
-	if (window->isMaximized()) {
-		auto rect = window->rect();
+/**
+ * Node of the cached dock area hit test index. The index mirrors the tree
+ * of visible splitters and dock areas. All rectangles are stored in
+ * container coordinates, so moving the container window does not
+ * invalidate the index.
+ */
+struct DockAreaIndexNode
+{
+	QRect Rect;///< geometry in container coordinates
+	CDockAreaWidget* DockArea = nullptr;///< nullptr for splitter nodes
+	Qt::Orientation Orientation = Qt::Horizontal;///< splitter orientation
+	QVector<int> Children;///< child node indices, sorted by position
+};
 
-		window->resize(rect.width() - 1, rect.height() - 1);
-		window->resize(rect.width(), rect.height());
-		
-		window->showMaximized();
-	}
-	else {
-		/*auto rect = window->rect();
-		window->resize(rect.width() - 100, rect.height() - 100);
-		window->resize(rect.width(), rect.height());
-		window->adjustSize();*/
-		window->showMaximized();
-		window->showNormal();
-	}
-}
 
 /**
  * Private data class of CDockContainerWidget class (pimpl)
@@ -167,6 +175,17 @@ public:
 	int VisibleDockAreaCount = -1;
 	CDockAreaWidget* TopLevelDockArea = nullptr;
 	std::function<QList<int>(const QList<int> &)> adjust_size_handler_;
+	QVector<DockAreaIndexNode> DockAreaIndex;
+	bool DockAreaIndexValid = false;
+	QList<CDockAreaWidget*> OpenedDockAreas;
+	bool OpenedDockAreasValid = false;
+	QList<QPointer<QWidget>> RelayoutWidgets;
+	bool RelayoutScheduled = false;
+	bool DeferredSplitterHandles = false;
+	bool DeferredDockAreasAdded = false;
+	bool DeferredDockAreasRemoved = false;
+	QList<QPointer<QSplitter>> DeferredSizeSplitters;
+	QObject* DockLayoutObserver = nullptr;
 
 	/**
 	 * Private data constructor
@@ -266,6 +285,75 @@ public:
 	bool restoreDockArea(CDockingStateReader& Stream, QWidget*& CreatedWidget,
 		bool Testing);
 
+	/**
+	 * Save state of child nodes into the flat pre-order node list
+	 */
+	void saveChildNodesState(QVector<DockLayoutNode>& Nodes, QWidget* Widget);
+
+	/**
+	 * Restores the layout subtree that starts at node Index and moves Index
+	 * behind the subtree. The node list has already been validated when it
+	 * was parsed, so this function does not need a testing mode.
+	 * Returns the created widget or 0 if the subtree did not contain any
+	 * known dock widget.
+	 */
+	QWidget* restoreChildNodes(const QVector<DockLayoutNode>& Nodes, int& Index);
+
+	/**
+	 * Restores a splitter node.
+	 * \see restoreChildNodes() for details
+	 */
+	QWidget* restoreSplitter(const QVector<DockLayoutNode>& Nodes, int& Index);
+
+	/**
+	 * Restores a dock area node.
+	 * \see restoreChildNodes() for details
+	 */
+	QWidget* restoreDockArea(const QVector<DockLayoutNode>& Nodes, int& Index);
+
+	/**
+	 * Adds the given splitter and all its child splitters to the splitter set
+	 */
+	void collectSplitters(QSplitter* Splitter, QSet<QSplitter*>& Splitters);
+
+	/**
+	 * Assigns an existing dock area to each area node of the new layout.
+	 * Each area node gets the unused existing dock area that contains most
+	 * of its dock widgets.
+	 */
+	void assignReusedDockAreas(const QVector<DockLayoutNode>& Nodes,
+		LayoutReuseContext& Context);
+
+	/**
+	 * Restores the layout subtree that starts at node Index like
+	 * restoreChildNodes() but reuses the existing dock areas and splitters
+	 * whenever possible, so that unchanged dock widgets are not reparented.
+	 */
+	QWidget* reuseChildNodes(const QVector<DockLayoutNode>& Nodes, int& Index,
+		LayoutReuseContext& Context);
+
+	/**
+	 * Restores a splitter node and reuses an existing splitter if possible.
+	 * \see reuseChildNodes() for details
+	 */
+	QWidget* reuseSplitter(const QVector<DockLayoutNode>& Nodes, int& Index,
+		LayoutReuseContext& Context);
+
+	/**
+	 * Restores a dock area node and reuses an existing dock area if possible.
+	 * \see reuseChildNodes() for details
+	 */
+	QWidget* reuseDockArea(const QVector<DockLayoutNode>& Nodes, int& Index,
+		LayoutReuseContext& Context);
+
+	/**
+	 * Ensures that the given dock area contains exactly the given dock widgets
+	 * in the given order. Dock widgets that are already at the right position
+	 * are not touched.
+	 */
+	void syncDockAreaWidgets(CDockAreaWidget* DockArea,
+		const QList<CDockWidget*>& DockWidgets);
+
 	/**
 	 * Helper function for recursive dumping of layout
 	 */
@@ -305,6 +393,89 @@ public:
 		return VisibleDockAreaCount;
 	}
 
+	/**
+	 * Updates the visible dock area counter if a dock area is shown or hidden
+	 * explicitly. The counter is only updated if it is already initialized.
+	 */
+	void onDockAreaShownOrHidden(bool Visible)
+	{
+		OpenedDockAreasValid = false;
+		if (VisibleDockAreaCount > -1)
+		{
+			VisibleDockAreaCount += Visible ? 1 : -1;
+		}
+	}
+
+	/**
+	 * Compares the visible dock area counter with the number of visible dock
+	 * areas. Used in debug builds to detect missed counter updates.
+	 */
+	void checkVisibleDockAreaCount()
+	{
+		if (VisibleDockAreaCount < 0)
+		{
+			return;
+		}
+
+		int Count = 0;
+		for (auto DockArea : DockAreas)
+		{
+			Count += DockArea->isHidden() ? 0 : 1;
+		}
+		Q_ASSERT_X(Count == VisibleDockAreaCount, "visibleDockAreaCount",
+			"visible dock area counter is out of sync");
+	}
+
+	/**
+	 * Returns the cached list of opened dock areas. The list is rebuilt if
+	 * dock areas have been added, removed, shown or hidden since the last
+	 * call.
+	 */
+	const QList<CDockAreaWidget*>& openedDockAreas()
+	{
+		if (!OpenedDockAreasValid)
+		{
+			OpenedDockAreas.clear();
+			for (auto DockArea : DockAreas)
+			{
+				if (!DockArea->isHidden())
+				{
+					OpenedDockAreas.append(DockArea);
+				}
+			}
+			OpenedDockAreasValid = true;
+		}
+
+		return OpenedDockAreas;
+	}
+
+	/**
+	 * Invalidates all caches that depend on the dock area list
+	 */
+	void onDockAreaListChanged()
+	{
+		OpenedDockAreasValid = false;
+		invalidateDockAreaIndex();
+	}
+
+	/**
+	 * Removes the given dock area from the internal dock area list
+	 */
+	void removeDockAreaFromList(CDockAreaWidget* DockArea)
+	{
+		if (!DockAreas.removeAll(DockArea))
+		{
+			return;
+		}
+
+		DockArea->removeEventFilter(DockLayoutObserver);
+		if (!DockArea->isHidden())
+		{
+			onDockAreaShownOrHidden(false);
+		}
+		onDockAreaListChanged();
+	}
+
 	/**
 	 * The visible dock area count changes, if dock areas are remove, added or
 	 * when its view is toggled
@@ -313,16 +484,50 @@ public:
 
 	void emitDockAreasRemoved()
 	{
+		if (isLayoutUpdating())
+		{
+			DeferredDockAreasRemoved = true;
+			return;
+		}
+
 		onVisibleDockAreaCountChanged();
 		emit _this->dockAreasRemoved();
 	}
 
 	void emitDockAreasAdded()
 	{
+		if (isLayoutUpdating())
+		{
+			DeferredDockAreasAdded = true;
+			return;
+		}
+
 		onVisibleDockAreaCountChanged();
 		emit _this->dockAreasAdded();
 	}
 
+	/**
+	 * Returns true, if the dock manager is inside of a layout update
+	 * transaction. Splitter sizing, splitter handle updates and signal
+	 * emission are deferred until the transaction is finished.
+	 * \see CDockManager::beginLayoutUpdate()
+	 */
+	bool isLayoutUpdating() const
+	{
+		return DockManager && DockManager->isLayoutUpdating();
+	}
+
+	/**
+	 * Applies all updates that have been deferred during a layout update
+	 * transaction
+	 */
+	void applyDeferredLayoutUpdates();
+
+	/**
+	 * Updates the handles of the given splitter and all its child splitters
+	 */
+	void updateAllSplitterHandles(QSplitter* Splitter);
+
 	/**
 	 * Helper function for creation of new splitter
 	 */
@@ -331,9 +536,43 @@ public:
 		CDockSplitter* s = new CDockSplitter(orientation, parent);
 		s->setOpaqueResize(CDockManager::testConfigFlag(CDockManager::OpaqueSplitterResize));
 		s->setChildrenCollapsible(false);
+		s->installEventFilter(DockLayoutObserver);
 		return s;
 	}
 
+	/**
+	 * Schedules a relayout of the given splitter subtree. All relayout
+	 * requests of one event loop iteration are coalesced into a single
+	 * layout pass.
+	 */
+	void scheduleRelayout(QWidget* Widget);
+
+	/**
+	 * Executes the scheduled relayout pass
+	 */
+	void relayout();
+
+	/**
+	 * Marks the dock area hit test index as dirty. It is rebuilt on the
+	 * next call of dockAreaAt()
+	 */
+	void invalidateDockAreaIndex()
+	{
+		DockAreaIndexValid = false;
+	}
+
+	/**
+	 * Adds the index nodes for the given widget and all its visible children
+	 * and returns the index of the node of the given widget
+	 */
+	int buildDockAreaIndex(QWidget* Widget);
+
+	/**
+	 * Returns the dock area at the given position in container coordinates.
+	 * The lookup uses a binary search in each splitter level.
+	 */
+	CDockAreaWidget* dockAreaAt(const QPoint& Pos);
+
 	void adjust_size_handler(const std::function<QList<int>(const QList<int>&)>& handler) {
 		adjust_size_handler_ = handler;
 	}
@@ -343,6 +582,17 @@ public:
 	 */
 	void adjustSplitterSizesOnInsertion(QSplitter* Splitter, qreal LastRatio = 1.0)
 	{
+		// Inside of a layout update the sizes are distributed only once when
+		// the transaction is finished
+		if (isLayoutUpdating() && LastRatio == 1.0)
+		{
+			if (!DeferredSizeSplitters.contains(Splitter))
+			{
+				DeferredSizeSplitters.append(Splitter);
+			}
+			return;
+		}
+
 		int AreaSize = (Splitter->orientation() == Qt::Horizontal) ? Splitter->width() : Splitter->height();
 		auto SplitterSizes = Splitter->sizes();
 
@@ -375,19 +625,68 @@ public:
 // private slots: ------------------------------------------------------------
 	void onDockAreaViewToggled(bool Visible)
 	{
+		// The visible dock area counter has already been updated by the
+		// layout observer when the dock area has been shown or hidden
 		CDockAreaWidget* DockArea = qobject_cast<CDockAreaWidget*>(_this->sender());
-		VisibleDockAreaCount += Visible ? 1 : -1;
 		onVisibleDockAreaCountChanged();
 		emit _this->dockAreaViewToggled(DockArea, Visible);
 	}
 }; // struct DockContainerWidgetPrivate
 
 
+/**
+ * Event filter for the splitters and dock areas of a container. It
+ * invalidates the dock area hit test index if the geometry or the
+ * visibility of a splitter or dock area changes or if the children of a
+ * splitter change. It also keeps the visible dock area count up to date.
+ */
+class CDockLayoutObserver : public QObject
+{
+public:
+	DockContainerWidgetPrivate* d;
+
+	CDockLayoutObserver(DockContainerWidgetPrivate* Private, QObject* Parent)
+		: QObject(Parent),
+		  d(Private)
+	{}
+
+	virtual bool eventFilter(QObject* Watched, QEvent* Event) override
+	{
+		switch (Event->type())
+		{
+		case QEvent::ShowToParent:
+		case QEvent::HideToParent:
+			// Dock areas that have been removed from the container by a
+			// restore may still be shown or hidden until they are deleted
+			if (d->DockAreas.contains(qobject_cast<CDockAreaWidget*>(Watched)))
+			{
+				d->onDockAreaShownOrHidden(Event->type() == QEvent::ShowToParent);
+			}
+			d->invalidateDockAreaIndex();
+			break;
+
+		case QEvent::Move:
+		case QEvent::Resize:
+		case QEvent::ChildAdded:
+		case QEvent::ChildRemoved:
+			d->invalidateDockAreaIndex();
+			break;
+
+		default:
+			break;
+		}
+
+		return QObject::eventFilter(Watched, Event);
+	}
+};
+
+
 //============================================================================
 DockContainerWidgetPrivate::DockContainerWidgetPrivate(CDockContainerWidget* _public) :
 	_this(_public)
 {
 	std::fill(std::begin(LastAddedAreaCache),std::end(LastAddedAreaCache), nullptr);
+	DockLayoutObserver = new CDockLayoutObserver(this, _public);
 }
 
 
@@ -681,7 +980,7 @@ void DockContainerWidgetPrivate::moveIntoCenterOfSection(QWidget* Widget, CDockA
 		}
 		TargetArea->setCurrentIndex(NewCurrentIndex);
 		DroppedArea->dockContainer()->removeDockArea(DroppedArea);
-		DroppedArea->deleteLater();
+		internal::deleteLater(DroppedArea);
 	}
 
 	TargetArea->updateTitleBarVisibility();
@@ -755,11 +1054,19 @@ void DockContainerWidgetPrivate::moveToNewSection(QWidget* Widget, CDockAreaWidg
 //============================================================================
 void DockContainerWidgetPrivate::updateSplitterHandles( QSplitter* splitter )
 {
+	if (isLayoutUpdating())
+	{
+		DeferredSplitterHandles = true;
+		return;
+	}
+
 	if (!DockManager->centralWidget() || !splitter)
 	{
 		return;
 	}
 
+	CDockMetricScope Metric(SplitterHandleUpdates);
+
 	for (int i = 0; i < splitter->count(); ++i)
     {
 		splitter->setStretchFactor(i, widgetResizesWithContainer(splitter->widget(i)) ? 1 : 0);
@@ -767,6 +1074,60 @@ void DockContainerWidgetPrivate::updateSplitterHandles( QSplitter* splitter )
 }
 
 
+//============================================================================
+void DockContainerWidgetPrivate::updateAllSplitterHandles(QSplitter* Splitter)
+{
+	if (!Splitter)
+	{
+		return;
+	}
+
+	updateSplitterHandles(Splitter);
+	for (int i = 0; i < Splitter->count(); ++i)
+	{
+		updateAllSplitterHandles(qobject_cast<QSplitter*>(Splitter->widget(i)));
+	}
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::applyDeferredLayoutUpdates()
+{
+	if (DeferredSplitterHandles)
+	{
+		DeferredSplitterHandles = false;
+		updateAllSplitterHandles(RootSplitter);
+	}
+
+	auto SizeSplitters = DeferredSizeSplitters;
+	DeferredSizeSplitters.clear();
+	for (const auto& Splitter : SizeSplitters)
+	{
+		if (Splitter)
+		{
+			adjustSplitterSizesOnInsertion(Splitter);
+		}
+	}
+
+	for (auto DockArea : DockAreas)
+	{
+		DockArea->updateTitleBarVisibility();
+	}
+
+	if (DeferredDockAreasRemoved)
+	{
+		DeferredDockAreasRemoved = false;
+		emitDockAreasRemoved();
+	}
+
+	if (DeferredDockAreasAdded)
+	{
+		DeferredDockAreasAdded = false;
+		emitDockAreasAdded();
+	}
+}
+
+
 //============================================================================
 bool DockContainerWidgetPrivate::widgetResizesWithContainer(QWidget* widget)
 {
@@ -872,8 +1233,22 @@ void DockContainerWidgetPrivate::addDockAreasToList(const QList<CDockAreaWidget*
 void DockContainerWidgetPrivate::appendDockAreas(const QList<CDockAreaWidget*> NewDockAreas)
 {
 	DockAreas.append(NewDockAreas);
+	onDockAreaListChanged();
 	for (auto DockArea : NewDockAreas)
 	{
+		// Dock areas that have never been shown or hidden explicitly change
+		// their hidden state implicitly together with their parent. We make
+		// the state explicit, so that every later change is reported to the
+		// layout observer via a ShowToParent or HideToParent event.
+		if (!DockArea->testAttribute(Qt::WA_WState_ExplicitShowHide))
+		{
+			DockArea->setVisible(true);
+		}
+		if (!DockArea->isHidden())
+		{
+			onDockAreaShownOrHidden(true);
+		}
+		DockArea->installEventFilter(DockLayoutObserver);
 		QObject::connect(DockArea,
 			&CDockAreaWidget::viewToggled,
 			_this,
@@ -1154,70 +1529,475 @@ bool DockContainerWidgetPrivate::restoreChildNodes(CDockingStateReader& s,
 
 
 //============================================================================
-CDockAreaWidget* DockContainerWidgetPrivate::addDockWidgetToContainer(DockWidgetArea area,
-	CDockWidget* Dockwidget)
+void DockContainerWidgetPrivate::saveChildNodesState(QVector<DockLayoutNode>& Nodes,
+	QWidget* Widget)
 {
-	CDockAreaWidget* NewDockArea = new CDockAreaWidget(DockManager, _this);
-	NewDockArea->addDockWidget(Dockwidget);
-	addDockArea(NewDockArea, area);
-	NewDockArea->updateTitleBarVisibility();
-	LastAddedAreaCache[areaIdToIndex(area)] = NewDockArea;
-	return NewDockArea;
-}
+	QSplitter* Splitter = qobject_cast<QSplitter*>(Widget);
+	if (Splitter)
+	{
+		// The splitter node is written after its children because only then
+		// the number of stored children is known
+		int NodeIndex = Nodes.count();
+		Nodes.append(DockLayoutNode());
+		DockLayoutNode Node;
+		Node.Type = DockLayoutNode::SplitterNode;
+		Node.Orientation = Splitter->orientation();
+		auto Sizes = Splitter->sizes();
+		for (int i = 0; i < Splitter->count(); ++i)
+		{
+			QWidget* Child = Splitter->widget(i);
+			if (!qobject_cast<QSplitter*>(Child) && !qobject_cast<CDockAreaWidget*>(Child))
+			{
+				continue;
+			}
 
+			saveChildNodesState(Nodes, Child);
+			Node.Sizes.append(Sizes[i]);
+			Node.Count++;
+		}
+		Nodes[NodeIndex] = Node;
+		return;
+	}
 
-//============================================================================
-void DockContainerWidgetPrivate::addDockArea(CDockAreaWidget* NewDockArea, DockWidgetArea area)
-{
-	auto InsertParam = internal::dockAreaInsertParameters(area);
-	// As long as we have only one dock area in the splitter we can adjust
-	// its orientation
-	if (DockAreas.count() <= 1)
+	CDockAreaWidget* DockArea = qobject_cast<CDockAreaWidget*>(Widget);
+	if (!DockArea)
 	{
-		RootSplitter->setOrientation(InsertParam.orientation());
+		return;
 	}
 
-	QSplitter* Splitter = RootSplitter;
-	if (Splitter->orientation() == InsertParam.orientation())
+	DockLayoutNode AreaNode;
+	AreaNode.Type = DockLayoutNode::AreaNode;
+	auto CurrentDockWidget = DockArea->currentDockWidget();
+	AreaNode.Name = CurrentDockWidget ? CurrentDockWidget->objectName() : QString();
+	// Like the XML state, we only store the allowed areas and the dock area
+	// flags if the values are different from the default values
+	if (DockArea->allowedAreas() != AllDockAreas)
 	{
-		insertWidgetIntoSplitter(Splitter, NewDockArea, InsertParam.append());
-        updateSplitterHandles(Splitter);
-        if (Splitter->isHidden())
-		{
-			Splitter->show();
-		}
+		AreaNode.AllowedAreas = int(DockArea->allowedAreas());
 	}
-	else
+	if (DockArea->dockAreaFlags() != CDockAreaWidget::DefaultFlags)
 	{
-		QSplitter* NewSplitter = newSplitter(InsertParam.orientation());
-		if (InsertParam.append())
-		{
-			QLayoutItem* li = Layout->replaceWidget(Splitter, NewSplitter);
-			NewSplitter->addWidget(Splitter);
-			NewSplitter->addWidget(NewDockArea);
-            updateSplitterHandles(NewSplitter);
-            delete li;
-		}
-		else
-		{
-			NewSplitter->addWidget(NewDockArea);
-			QLayoutItem* li = Layout->replaceWidget(Splitter, NewSplitter);
-			NewSplitter->addWidget(Splitter);
-            updateSplitterHandles(NewSplitter);
-            delete li;
-		}
-		RootSplitter = NewSplitter;
+		AreaNode.Flags = int(DockArea->dockAreaFlags());
+	}
+	AreaNode.Count = DockArea->dockWidgetsCount();
+	Nodes.append(AreaNode);
+	for (int i = 0; i < AreaNode.Count; ++i)
+	{
+		DockLayoutNode WidgetNode;
+		WidgetNode.Type = DockLayoutNode::WidgetNode;
+		WidgetNode.Name = DockArea->dockWidget(i)->objectName();
+		WidgetNode.Closed = DockArea->dockWidget(i)->isClosed();
+		Nodes.append(WidgetNode);
 	}
-
-	addDockAreasToList({NewDockArea});
 }
 
 
 //============================================================================
-void DockContainerWidgetPrivate::dumpRecursive(int level, QWidget* widget)
+QWidget* DockContainerWidgetPrivate::restoreSplitter(const QVector<DockLayoutNode>& Nodes,
+	int& Index)
 {
-#if defined(QT_DEBUG)
-	QSplitter* Splitter = qobject_cast<QSplitter*>(widget);
+	const auto& Node = Nodes[Index++];
+	QSplitter* Splitter = newSplitter(Node.Orientation);
+	bool Visible = false;
+	for (int i = 0; i < Node.Count; ++i)
+	{
+		QWidget* ChildNode = restoreChildNodes(Nodes, Index);
+		if (!ChildNode)
+		{
+			continue;
+		}
+
+		Splitter->addWidget(ChildNode);
+		Visible |= ChildNode->isVisibleTo(Splitter);
+	}
+	updateSplitterHandles(Splitter);
+
+	if (!Splitter->count())
+	{
+		delete Splitter;
+		return nullptr;
+	}
+
+	Splitter->setSizes(Node.Sizes);
+	Splitter->setVisible(Visible);
+	return Splitter;
+}
+
+
+//============================================================================
+QWidget* DockContainerWidgetPrivate::restoreDockArea(const QVector<DockLayoutNode>& Nodes,
+	int& Index)
+{
+	const auto& Node = Nodes[Index++];
+	CDockAreaWidget* DockArea = new CDockAreaWidget(DockManager, _this);
+	if (Node.AllowedAreas >= 0)
+	{
+		DockArea->setAllowedAreas((DockWidgetArea)Node.AllowedAreas);
+	}
+
+	if (Node.Flags >= 0)
+	{
+		DockArea->setDockAreaFlags((CDockAreaWidget::DockAreaFlags)Node.Flags);
+	}
+
+	for (int i = 0; i < Node.Count; ++i)
+	{
+		const auto& WidgetNode = Nodes[Index++];
+		CDockWidget* DockWidget = DockManager->findDockWidget(WidgetNode.Name);
+		if (!DockWidget)
+		{
+			continue;
+		}
+
+		// We hide the DockArea here to prevent the short display (the flashing)
+		// of the dock areas during application startup
+		DockArea->hide();
+		DockArea->addDockWidget(DockWidget);
+		DockWidget->setToggleViewActionChecked(!WidgetNode.Closed);
+		DockWidget->setClosedState(WidgetNode.Closed);
+		DockWidget->setProperty(internal::ClosedProperty, WidgetNode.Closed);
+		DockWidget->setProperty(internal::DirtyProperty, false);
+	}
+
+	if (!DockArea->dockWidgetsCount())
+	{
+		delete DockArea;
+		return nullptr;
+	}
+
+	DockArea->setProperty("currentDockWidget", Node.Name);
+	appendDockAreas({DockArea});
+	return DockArea;
+}
+
+
+//============================================================================
+QWidget* DockContainerWidgetPrivate::restoreChildNodes(const QVector<DockLayoutNode>& Nodes,
+	int& Index)
+{
+	if (DockLayoutNode::SplitterNode == Nodes[Index].Type)
+	{
+		return restoreSplitter(Nodes, Index);
+	}
+	else
+	{
+		return restoreDockArea(Nodes, Index);
+	}
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::collectSplitters(QSplitter* Splitter,
+	QSet<QSplitter*>& Splitters)
+{
+	if (!Splitter)
+	{
+		return;
+	}
+
+	Splitters.insert(Splitter);
+	for (int i = 0; i < Splitter->count(); ++i)
+	{
+		collectSplitters(qobject_cast<QSplitter*>(Splitter->widget(i)), Splitters);
+	}
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::assignReusedDockAreas(const QVector<DockLayoutNode>& Nodes,
+	LayoutReuseContext& Context)
+{
+	QSet<CDockAreaWidget*> AssignedDockAreas;
+	for (int i = 0; i < Nodes.count(); ++i)
+	{
+		const auto& Node = Nodes[i];
+		if (Node.Type != DockLayoutNode::AreaNode)
+		{
+			continue;
+		}
+
+		// Count how many of the dock widgets of this node are in each
+		// existing dock area
+		QList<CDockAreaWidget*> Candidates;
+		QList<int> Overlaps;
+		for (int w = i + 1; w <= i + Node.Count; ++w)
+		{
+			CDockWidget* DockWidget = DockManager->findDockWidget(Nodes[w].Name);
+			CDockAreaWidget* DockArea = DockWidget ? DockWidget->dockAreaWidget() : nullptr;
+			if (!DockArea || !Context.OldDockAreas.contains(DockArea)
+			 || AssignedDockAreas.contains(DockArea))
+			{
+				continue;
+			}
+
+			int CandidateIndex = Candidates.indexOf(DockArea);
+			if (CandidateIndex < 0)
+			{
+				Candidates.append(DockArea);
+				Overlaps.append(1);
+			}
+			else
+			{
+				Overlaps[CandidateIndex]++;
+			}
+		}
+
+		int BestIndex = -1;
+		for (int c = 0; c < Candidates.count(); ++c)
+		{
+			if (BestIndex < 0 || Overlaps[c] > Overlaps[BestIndex])
+			{
+				BestIndex = c;
+			}
+		}
+
+		if (BestIndex >= 0)
+		{
+			Context.AreaForNode.insert(i, Candidates[BestIndex]);
+			AssignedDockAreas.insert(Candidates[BestIndex]);
+		}
+	}
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::syncDockAreaWidgets(CDockAreaWidget* DockArea,
+	const QList<CDockWidget*>& DockWidgets)
+{
+	for (auto DockWidget : DockArea->dockWidgets())
+	{
+		if (!DockWidgets.contains(DockWidget))
+		{
+			DockArea->releaseDockWidget(DockWidget);
+		}
+	}
+
+	for (int i = 0; i < DockWidgets.count(); ++i)
+	{
+		auto DockWidget = DockWidgets[i];
+		if (DockArea->index(DockWidget) == i)
+		{
+			continue;
+		}
+
+		CDockAreaWidget* OldDockArea = DockWidget->dockAreaWidget();
+		if (OldDockArea)
+		{
+			OldDockArea->releaseDockWidget(DockWidget);
+		}
+		DockArea->insertDockWidget(i, DockWidget, false);
+	}
+}
+
+
+//============================================================================
+QWidget* DockContainerWidgetPrivate::reuseSplitter(const QVector<DockLayoutNode>& Nodes,
+	int& Index, LayoutReuseContext& Context)
+{
+	const auto& Node = Nodes[Index++];
+	QList<QWidget*> Children;
+	for (int i = 0; i < Node.Count; ++i)
+	{
+		QWidget* ChildNode = reuseChildNodes(Nodes, Index, Context);
+		if (ChildNode)
+		{
+			Children.append(ChildNode);
+		}
+	}
+
+	if (Children.isEmpty())
+	{
+		return nullptr;
+	}
+
+	// We reuse the splitter that currently contains the first child if it
+	// has the right orientation and if it is not contained in one of the
+	// children - otherwise we would create a parent child cycle
+	QSplitter* Splitter = qobject_cast<QSplitter*>(Children.first()->parentWidget());
+	bool ReuseSplitter = Splitter && Context.OldSplitters.contains(Splitter)
+		&& !Context.UsedSplitters.contains(Splitter)
+		&& Splitter->orientation() == Node.Orientation;
+	for (int i = 0; ReuseSplitter && i < Children.count(); ++i)
+	{
+		ReuseSplitter = !Children[i]->isAncestorOf(Splitter);
+	}
+
+	if (!ReuseSplitter)
+	{
+		Splitter = newSplitter(Node.Orientation);
+	}
+	Context.UsedSplitters.insert(Splitter);
+
+	bool Visible = false;
+	for (int i = 0; i < Children.count(); ++i)
+	{
+		if (Splitter->indexOf(Children[i]) != i)
+		{
+			Splitter->insertWidget(i, Children[i]);
+		}
+		Visible |= Children[i]->isVisibleTo(Splitter);
+	}
+
+	// The remaining children of a reused splitter are stale. They are
+	// detached before setSizes(), otherwise the sizes would be distributed
+	// to them. They are reused by a later node or deleted after the restore.
+	while (Splitter->count() > Children.count())
+	{
+		Splitter->widget(Children.count())->setParent(_this);
+	}
+	updateSplitterHandles(Splitter);
+	Splitter->setSizes(Node.Sizes);
+	Splitter->setVisible(Visible);
+	return Splitter;
+}
+
+
+//============================================================================
+QWidget* DockContainerWidgetPrivate::reuseDockArea(const QVector<DockLayoutNode>& Nodes,
+	int& Index, LayoutReuseContext& Context)
+{
+	int NodeIndex = Index;
+	const auto& Node = Nodes[Index++];
+	QList<CDockWidget*> DockWidgets;
+	QList<bool> ClosedStates;
+	for (int i = 0; i < Node.Count; ++i)
+	{
+		const auto& WidgetNode = Nodes[Index++];
+		CDockWidget* DockWidget = DockManager->findDockWidget(WidgetNode.Name);
+		if (DockWidget)
+		{
+			DockWidgets.append(DockWidget);
+			ClosedStates.append(WidgetNode.Closed);
+		}
+	}
+
+	if (DockWidgets.isEmpty())
+	{
+		return nullptr;
+	}
+
+	CDockAreaWidget* DockArea = Context.AreaForNode.value(NodeIndex, nullptr);
+	bool Reused = (DockArea != nullptr);
+	if (!Reused)
+	{
+		DockArea = new CDockAreaWidget(DockManager, _this);
+		// We hide the DockArea here to prevent the short display (the flashing)
+		// of the new dock area
+		DockArea->hide();
+	}
+
+	// A reused dock area needs to get the default values if the saved state
+	// does not contain explicit values
+	DockArea->setAllowedAreas((Node.AllowedAreas >= 0)
+		? (DockWidgetArea)Node.AllowedAreas : AllDockAreas);
+	DockArea->setDockAreaFlags((Node.Flags >= 0)
+		? (CDockAreaWidget::DockAreaFlags)Node.Flags : CDockAreaWidget::DefaultFlags);
+	syncDockAreaWidgets(DockArea, DockWidgets);
+	for (int i = 0; i < DockWidgets.count(); ++i)
+	{
+		bool Closed = ClosedStates[i];
+		auto DockWidget = DockWidgets[i];
+		DockWidget->setToggleViewActionChecked(!Closed);
+		DockWidget->setClosedState(Closed);
+		DockWidget->setProperty(internal::ClosedProperty, Closed);
+		DockWidget->setProperty(internal::DirtyProperty, false);
+	}
+
+	DockArea->setProperty("currentDockWidget", Node.Name);
+	if (Reused)
+	{
+		// Reused dock areas are already connected to this container
+		DockAreas.append(DockArea);
+		onDockAreaListChanged();
+	}
+	else
+	{
+		appendDockAreas({DockArea});
+	}
+	return DockArea;
+}
+
+
+//============================================================================
+QWidget* DockContainerWidgetPrivate::reuseChildNodes(const QVector<DockLayoutNode>& Nodes,
+	int& Index, LayoutReuseContext& Context)
+{
+	if (DockLayoutNode::SplitterNode == Nodes[Index].Type)
+	{
+		return reuseSplitter(Nodes, Index, Context);
+	}
+	else
+	{
+		return reuseDockArea(Nodes, Index, Context);
+	}
+}
+
+
+//============================================================================
+CDockAreaWidget* DockContainerWidgetPrivate::addDockWidgetToContainer(DockWidgetArea area,
+	CDockWidget* Dockwidget)
+{
+	CDockAreaWidget* NewDockArea = new CDockAreaWidget(DockManager, _this);
+	NewDockArea->addDockWidget(Dockwidget);
+	addDockArea(NewDockArea, area);
+	NewDockArea->updateTitleBarVisibility();
+	LastAddedAreaCache[areaIdToIndex(area)] = NewDockArea;
+	return NewDockArea;
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::addDockArea(CDockAreaWidget* NewDockArea, DockWidgetArea area)
+{
+	auto InsertParam = internal::dockAreaInsertParameters(area);
+	// As long as we have only one dock area in the splitter we can adjust
+	// its orientation
+	if (DockAreas.count() <= 1)
+	{
+		RootSplitter->setOrientation(InsertParam.orientation());
+	}
+
+	QSplitter* Splitter = RootSplitter;
+	if (Splitter->orientation() == InsertParam.orientation())
+	{
+		insertWidgetIntoSplitter(Splitter, NewDockArea, InsertParam.append());
+        updateSplitterHandles(Splitter);
+        if (Splitter->isHidden())
+		{
+			Splitter->show();
+		}
+	}
+	else
+	{
+		QSplitter* NewSplitter = newSplitter(InsertParam.orientation());
+		if (InsertParam.append())
+		{
+			QLayoutItem* li = Layout->replaceWidget(Splitter, NewSplitter);
+			NewSplitter->addWidget(Splitter);
+			NewSplitter->addWidget(NewDockArea);
+            updateSplitterHandles(NewSplitter);
+            delete li;
+		}
+		else
+		{
+			NewSplitter->addWidget(NewDockArea);
+			QLayoutItem* li = Layout->replaceWidget(Splitter, NewSplitter);
+			NewSplitter->addWidget(Splitter);
+            updateSplitterHandles(NewSplitter);
+            delete li;
+		}
+		RootSplitter = NewSplitter;
+	}
+
+	addDockAreasToList({NewDockArea});
+}
+
+
+//============================================================================
+void DockContainerWidgetPrivate::dumpRecursive(int level, QWidget* widget)
+{
+#if defined(QT_DEBUG)
+	QSplitter* Splitter = qobject_cast<QSplitter*>(widget);
 	QByteArray buf;
     buf.fill(' ', level * 4);
 	if (Splitter)
@@ -1391,7 +2171,9 @@ void CDockContainerWidget::removeDockWidget(CDockWidget* Dockwidget)
 	{
 		Area->removeDockWidget(Dockwidget);
 		if (Area->dockWidgetsCount() == 0 && d->DockAreas.count() > 1)
-			d->DockAreas.removeAll(Area);
+		{
+			d->removeDockAreaFromList(Area);
+		}
 	}
 }
 
@@ -1445,9 +2227,11 @@ void CDockContainerWidget::addDockArea(CDockAreaWidget* DockAreaWidget,
 void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 {
     ADS_PRINT("CDockContainerWidget::removeDockArea");
+	ADS_TRACE_SCOPE("CDockContainerWidget::removeDockArea");
 	area->disconnect(this);
-	d->DockAreas.removeAll(area);
+	d->removeDockAreaFromList(area);
 	CDockSplitter* Splitter = internal::findParent<CDockSplitter*>(area);
+	QWidget* RelayoutWidget = Splitter;
 
 	// Remove are from parent splitter and recursively hide tree of parent
 	// splitters if it has no visible content
@@ -1491,6 +2275,7 @@ void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 		ChildSplitter->setParent(nullptr);
 		QLayoutItem* li = d->Layout->replaceWidget(Splitter, ChildSplitter);
 		d->RootSplitter = ChildSplitter;
+		RelayoutWidget = ChildSplitter;
 		delete li;
         ADS_PRINT("RootSplitter replaced by child splitter");
 	}
@@ -1503,6 +2288,7 @@ void CDockContainerWidget::removeDockArea(CDockAreaWidget* area)
 		widget->setParent(this);
 		internal::replaceSplitterWidget(ParentSplitter, Splitter, widget);
 		ParentSplitter->setSizes(Sizes);
+		RelayoutWidget = ParentSplitter;
 	}
 
 	delete Splitter;
@@ -1517,26 +2303,178 @@ emitAndExit:
 	CDockWidget::emitTopLevelEventForWidget(TopLevelWidget, true);
 	dumpLayout();
 	d->emitDockAreasRemoved();
+	d->scheduleRelayout(RelayoutWidget);
+}
+
 
-	refresh(window());
+//============================================================================
+void DockContainerWidgetPrivate::scheduleRelayout(QWidget* Widget)
+{
+	if (!Widget)
+	{
+		return;
+	}
+
+	RelayoutWidgets.append(Widget);
+	if (RelayoutScheduled)
+	{
+		return;
+	}
+
+	RelayoutScheduled = true;
+	QTimer::singleShot(0, _this, [this]()
+	{
+		relayout();
+	});
 }
 
 
 //============================================================================
-CDockAreaWidget* CDockContainerWidget::dockAreaAt(const QPoint& GlobalPos) const
+void DockContainerWidgetPrivate::relayout()
 {
-	for (const auto& DockArea : d->DockAreas)
+	ADS_TRACE_SCOPE("DockContainerWidgetPrivate::relayout");
+	CDockMetricScope Metric(Relayouts);
+	RelayoutScheduled = false;
+	auto Widgets = RelayoutWidgets;
+	RelayoutWidgets.clear();
+	for (const auto& Widget : Widgets)
+	{
+		// The widget may have been deleted since the relayout was scheduled
+		if (!Widget || !_this->isAncestorOf(Widget))
+		{
+			continue;
+		}
+
+		// Recalculate the splitters and layouts from the changed subtree up
+		// to the container, so that the new geometries propagate without
+		// touching the native window
+		for (QWidget* w = Widget; w && w != _this; w = w->parentWidget())
+		{
+			QSplitter* Splitter = qobject_cast<QSplitter*>(w);
+			if (Splitter)
+			{
+				Splitter->refresh();
+			}
+			else if (w->layout())
+			{
+				w->layout()->invalidate();
+			}
+		}
+		Widget->update();
+	}
+
+	Layout->activate();
+}
+
+
+//============================================================================
+int DockContainerWidgetPrivate::buildDockAreaIndex(QWidget* Widget)
+{
+	// The node is added before its children and assigned after them, because
+	// the recursion may reallocate the node vector
+	int NodeIndex = DockAreaIndex.count();
+	DockAreaIndex.append(DockAreaIndexNode());
+	DockAreaIndexNode Node;
+	Node.Rect = QRect(Widget->mapTo(_this, QPoint(0, 0)), Widget->size());
+	QSplitter* Splitter = qobject_cast<QSplitter*>(Widget);
+	if (!Splitter)
 	{
-		if (DockArea->isVisible() && DockArea->rect().contains(DockArea->mapFromGlobal(GlobalPos)))
+		Node.DockArea = qobject_cast<CDockAreaWidget*>(Widget);
+		DockAreaIndex[NodeIndex] = Node;
+		return NodeIndex;
+	}
+
+	Node.Orientation = Splitter->orientation();
+	for (int i = 0; i < Splitter->count(); ++i)
+	{
+		QWidget* Child = Splitter->widget(i);
+		if (Child->isHidden())
 		{
-			return DockArea;
+			continue;
+		}
+
+		if (qobject_cast<QSplitter*>(Child) || qobject_cast<CDockAreaWidget*>(Child))
+		{
+			Node.Children.append(buildDockAreaIndex(Child));
 		}
 	}
 
+	// Sorting is required because horizontal splitters are laid out from
+	// right to left in right to left layouts
+	bool Horizontal = (Node.Orientation == Qt::Horizontal);
+	std::sort(Node.Children.begin(), Node.Children.end(), [&](int a, int b)
+	{
+		const QRect& A = DockAreaIndex[a].Rect;
+		const QRect& B = DockAreaIndex[b].Rect;
+		return Horizontal ? (A.left() < B.left()) : (A.top() < B.top());
+	});
+	DockAreaIndex[NodeIndex] = Node;
+	return NodeIndex;
+}
+
+
+//============================================================================
+CDockAreaWidget* DockContainerWidgetPrivate::dockAreaAt(const QPoint& Pos)
+{
+	if (!DockAreaIndexValid)
+	{
+		DockAreaIndex.clear();
+		if (RootSplitter)
+		{
+			buildDockAreaIndex(RootSplitter);
+		}
+		DockAreaIndexValid = true;
+	}
+
+	int NodeIndex = 0;
+	while (NodeIndex < DockAreaIndex.count())
+	{
+		const DockAreaIndexNode& Node = DockAreaIndex[NodeIndex];
+		if (!Node.Rect.contains(Pos))
+		{
+			return nullptr;
+		}
+
+		if (Node.DockArea)
+		{
+			return Node.DockArea;
+		}
+
+		// Find the last child that starts before the position. If the
+		// position is not inside of this child, it is on a splitter handle.
+		bool Horizontal = (Node.Orientation == Qt::Horizontal);
+		int Coordinate = Horizontal ? Pos.x() : Pos.y();
+		auto it = std::upper_bound(Node.Children.begin(), Node.Children.end(),
+			Coordinate, [&](int Value, int Child)
+			{
+				const QRect& Rect = DockAreaIndex[Child].Rect;
+				return Value < (Horizontal ? Rect.left() : Rect.top());
+			});
+		if (it == Node.Children.begin())
+		{
+			return nullptr;
+		}
+		NodeIndex = *(it - 1);
+	}
+
 	return nullptr;
 }
 
 
+//============================================================================
+CDockAreaWidget* CDockContainerWidget::dockAreaAt(const QPoint& GlobalPos) const
+{
+	// This function is called for every mouse move during drag operations,
+	// so it uses the cached hit test index instead of testing all dock areas
+	if (!isVisible())
+	{
+		return nullptr;
+	}
+
+	return d->dockAreaAt(mapFromGlobal(GlobalPos));
+}
+
+
 //============================================================================
 CDockAreaWidget* CDockContainerWidget::dockArea(int Index) const
 {
@@ -1561,17 +2499,12 @@ int CDockContainerWidget::dockAreaCount() const
 //============================================================================
 int CDockContainerWidget::visibleDockAreaCount() const
 {
-	int Result = 0;
-	for (auto DockArea : d->DockAreas)
-	{
-		Result += DockArea->isHidden() ? 0 : 1;
-	}
-
-	return Result;
-
-	// TODO Cache or precalculate this to speed it up because it is used during
-	// movement of floating widget
-	//return d->visibleDockAreaCount();
+	// The counter is maintained incrementally because this function is used
+	// during movement of floating widgets
+#if defined(QT_DEBUG)
+	d->checkVisibleDockAreaCount();
+#endif
+	return d->visibleDockAreaCount();
 }
 
 
@@ -1580,12 +2513,14 @@ void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWi
 	const QPoint& TargetPos)
 {
     ADS_PRINT("CDockContainerWidget::dropFloatingWidget");
+	ADS_TRACE_SCOPE("CDockContainerWidget::dropFloatingWidget");
 	CDockWidget* SingleDroppedDockWidget = FloatingWidget->topLevelDockWidget();
 	CDockWidget* SingleDockWidget = topLevelDockWidget();
 	CDockAreaWidget* DockArea = dockAreaAt(TargetPos);
 	auto dropArea = InvalidDockWidgetArea;
 	auto ContainerDropArea = d->DockManager->containerOverlay()->dropAreaUnderCursor();
 	bool Dropped = false;
+	QWidget* RelayoutWidget = nullptr;
 
 	if (DockArea)
 	{
@@ -1605,6 +2540,7 @@ void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWi
 		{
             ADS_PRINT("Dock Area Drop Content: " << dropArea);
 			Dropped = d->dropIntoSection(FloatingWidget, DockArea, dropArea);
+			RelayoutWidget = DockArea->parentWidget();
 		}
 	}
 
@@ -1617,12 +2553,13 @@ void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWi
 		{
 			d->dropIntoContainer(FloatingWidget, dropArea);
 			Dropped = true;
+			RelayoutWidget = d->RootSplitter;
 		}
 	}
 
 	if (Dropped)
 	{
-		FloatingWidget->deleteLater();
+		internal::deleteLater(FloatingWidget);
 
 		// If we dropped a floating widget with only one single dock widget, then we
 		// drop a top level widget that changes from floating to docked now
@@ -1636,9 +2573,11 @@ void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWi
 		{
 			SingleDroppedDockWidget->runDockStateHandler(true);
 		}
-	}
 
-	refresh(window());
+		// Only the splitter that received the dropped content needs a new
+		// layout. For a drop into the container, this is the root splitter.
+		d->scheduleRelayout(RelayoutWidget);
+	}
 
 	if (SingleDroppedDockWidget)
 	{
@@ -1651,6 +2590,7 @@ void CDockContainerWidget::dropFloatingWidget(CFloatingDockContainer* FloatingWi
 //============================================================================
 void CDockContainerWidget::dropWidget(QWidget* Widget, DockWidgetArea DropArea, CDockAreaWidget* TargetAreaWidget)
 {
+	ADS_TRACE_SCOPE("CDockContainerWidget::dropWidget");
 	if (!CDockManager::testConfigFlag(CDockManager::DropToCenter))
 		return;
 
@@ -1682,16 +2622,8 @@ void CDockContainerWidget::dropWidget(QWidget* Widget, DockWidgetArea DropArea,
 //============================================================================
 QList<CDockAreaWidget*> CDockContainerWidget::openedDockAreas() const
 {
-	QList<CDockAreaWidget*> Result;
-	for (auto DockArea : d->DockAreas)
-	{
-		if (!DockArea->isHidden())
-		{
-			Result.append(DockArea);
-		}
-	}
-
-	return Result;
+	// Returning the cached list is cheap because of implicit sharing
+	return d->openedDockAreas();
 }
 
 
@@ -1729,6 +2661,7 @@ bool CDockContainerWidget::restoreState(CDockingStateReader& s, bool Testing)
 	{
 		d->VisibleDockAreaCount = -1;// invalidate the dock area count
 		d->DockAreas.clear();
+		d->onDockAreaListChanged();
 		std::fill(std::begin(d->LastAddedAreaCache),std::end(d->LastAddedAreaCache), nullptr);
 	}
 
@@ -1770,16 +2703,157 @@ bool CDockContainerWidget::restoreState(CDockingStateReader& s, bool Testing)
 	{
 		NewRootSplitter = d->newSplitter(Qt::Horizontal);
 	}
+	else if (!qobject_cast<QSplitter*>(NewRootSplitter))
+	{
+		// A stream with a dock area as root element has already been
+		// restored at this point - we wrap the area into a root splitter
+		// because the container requires one
+		QSplitter* Splitter = d->newSplitter(Qt::Horizontal);
+		Splitter->addWidget(NewRootSplitter);
+		NewRootSplitter = Splitter;
+	}
 
 	d->Layout->replaceWidget(d->RootSplitter, NewRootSplitter);
 	QSplitter* OldRoot = d->RootSplitter;
 	d->RootSplitter = qobject_cast<QSplitter*>(NewRootSplitter);
-	OldRoot->deleteLater();
+	internal::deleteLater(OldRoot);
 
 	return true;
 }
 
 
+//============================================================================
+void CDockContainerWidget::saveState(DockLayoutContainer& State) const
+{
+	State.Floating = isFloating();
+	if (State.Floating)
+	{
+		State.Geometry = floatingWidget()->saveGeometry();
+	}
+	d->saveChildNodesState(State.Nodes, d->RootSplitter);
+}
+
+
+//============================================================================
+void CDockContainerWidget::restoreState(const DockLayoutContainer& State)
+{
+	ADS_PRINT("Restore CDockContainerWidget Floating" << State.Floating);
+	if (!State.Nodes.isEmpty() && State.Nodes[0].Type != DockLayoutNode::SplitterNode)
+	{
+		qWarning() << Q_FUNC_INFO << "Root node is not a splitter";
+		return;
+	}
+
+	d->VisibleDockAreaCount = -1;// invalidate the dock area count
+	d->DockAreas.clear();
+	d->onDockAreaListChanged();
+	std::fill(std::begin(d->LastAddedAreaCache),std::end(d->LastAddedAreaCache), nullptr);
+
+	if (State.Floating)
+	{
+		floatingWidget()->restoreGeometry(State.Geometry);
+	}
+
+	// An empty node list describes an empty root splitter
+	int Index = 0;
+	QWidget* NewRootSplitter = State.Nodes.isEmpty()
+		? nullptr : d->restoreChildNodes(State.Nodes, Index);
+	if (!NewRootSplitter)
+	{
+		NewRootSplitter = d->newSplitter(Qt::Horizontal);
+	}
+
+	d->Layout->replaceWidget(d->RootSplitter, NewRootSplitter);
+	QSplitter* OldRoot = d->RootSplitter;
+	d->RootSplitter = qobject_cast<QSplitter*>(NewRootSplitter);
+	internal::deleteLater(OldRoot);
+}
+
+
+//============================================================================
+void CDockContainerWidget::restoreStateIncremental(const DockLayoutContainer& State)
+{
+	ADS_PRINT("Restore CDockContainerWidget incremental Floating" << State.Floating);
+	if (!State.Nodes.isEmpty() && State.Nodes[0].Type != DockLayoutNode::SplitterNode)
+	{
+		qWarning() << Q_FUNC_INFO << "Root node is not a splitter";
+		return;
+	}
+
+	LayoutReuseContext Context;
+	for (auto DockArea : d->DockAreas)
+	{
+		Context.OldDockAreas.insert(DockArea);
+	}
+	d->collectSplitters(d->RootSplitter, Context.OldSplitters);
+
+	d->VisibleDockAreaCount = -1;// invalidate the dock area count
+	d->DockAreas.clear();
+	d->onDockAreaListChanged();
+	std::fill(std::begin(d->LastAddedAreaCache),std::end(d->LastAddedAreaCache), nullptr);
+
+	if (State.Floating)
+	{
+		floatingWidget()->restoreGeometry(State.Geometry);
+	}
+
+	d->assignReusedDockAreas(State.Nodes, Context);
+	int Index = 0;
+	QWidget* NewRootSplitter = State.Nodes.isEmpty()
+		? nullptr : d->reuseChildNodes(State.Nodes, Index, Context);
+	if (!NewRootSplitter)
+	{
+		NewRootSplitter = d->newSplitter(Qt::Horizontal);
+	}
+
+	if (NewRootSplitter != d->RootSplitter)
+	{
+		// If the old root splitter has been reused as a child splitter, it
+		// is not in the layout anymore and replaceWidget() will fail
+		QLayoutItem* li = d->Layout->replaceWidget(d->RootSplitter, NewRootSplitter);
+		if (li)
+		{
+			delete li;
+		}
+		else
+		{
+			d->Layout->addWidget(NewRootSplitter);
+		}
+		d->RootSplitter = qobject_cast<QSplitter*>(NewRootSplitter);
+	}
+
+	// Now all reused widgets are part of the new layout and we can remove
+	// the remaining dock areas and splitters of the old layout. Dock widgets
+	// that are still in these dock areas will be flagged as unassigned by
+	// the dock manager before the deferred delete happens.
+	QSet<CDockAreaWidget*> UsedDockAreas;
+	for (auto DockArea : Context.AreaForNode)
+	{
+		UsedDockAreas.insert(DockArea);
+	}
+
+	for (auto DockArea : Context.OldDockAreas)
+	{
+		if (!UsedDockAreas.contains(DockArea))
+		{
+			DockArea->hide();
+			DockArea->setParent(this);
+			internal::deleteLater(DockArea);
+		}
+	}
+
+	for (auto Splitter : Context.OldSplitters)
+	{
+		if (!Context.UsedSplitters.contains(Splitter))
+		{
+			Splitter->hide();
+			Splitter->setParent(this);
+			internal::deleteLater(Splitter);
+		}
+	}
+}
+
+
 //============================================================================
 QSplitter* CDockContainerWidget::rootSplitter() const
 {
@@ -1822,13 +2896,8 @@ CDockAreaWidget* CDockContainerWidget::lastAddedDockAreaWidget(DockWidgetArea ar
 //============================================================================
 bool CDockContainerWidget::hasTopLevelDockWidget() const
 {
-	auto DockAreas = openedDockAreas();
-	if (DockAreas.count() != 1)
-	{
-		return false;
-	}
-
-	return DockAreas[0]->openDockWidgetsCount() == 1;
+	auto TopLevelDockArea = topLevelDockArea();
+	return TopLevelDockArea && TopLevelDockArea->openDockWidgetsCount() == 1;
 }
 
 
@@ -1841,21 +2910,20 @@ CDockWidget* CDockContainerWidget::topLevelDockWidget() const
 		return nullptr;
 	}
 
-	auto DockWidgets = TopLevelDockArea->openedDockWidgets();
+	const auto DockWidgets = TopLevelDockArea->openedDockWidgets();
 	if (DockWidgets.count() != 1)
 	{
 		return nullptr;
 	}
 
 	return DockWidgets[0];
-
 }
 
 
 //============================================================================
 CDockAreaWidget* CDockContainerWidget::topLevelDockArea() const
 {
-	auto DockAreas = openedDockAreas();
+	const auto& DockAreas = d->openedDockAreas();
 	if (DockAreas.count() != 1)
 	{
 		return nullptr;
@@ -1878,6 +2946,13 @@ QList<CDockWidget*> CDockContainerWidget::dockWidgets() const
 }
 
 
+//============================================================================
+void CDockContainerWidget::applyDeferredLayoutUpdates()
+{
+	d->applyDeferredLayoutUpdates();
+}
+
+
 //============================================================================
 void CDockContainerWidget::updateSplitterHandles(QSplitter* splitter)
 {
@@ -0,0 +1,212 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockDragSession.cpp
+/// \date   16.10.2026
+/// \brief  Implementation of CDockDragSession
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockDragSession.h"
+
+#include <QEvent>
+
+#include <algorithm>
+
+#include "DockManager.h"
+#include "DockContainerWidget.h"
+#include "DockAreaWidget.h"
+
+namespace ads
+{
+//============================================================================
+CDockDragSession::CDockDragSession()
+{
+
+}
+
+
+//============================================================================
+CDockDragSession::~CDockDragSession()
+{
+	removeEventFilters();
+}
+
+
+//============================================================================
+void CDockDragSession::begin(CDockManager* DockManager,
+	CDockContainerWidget* ExcludedContainer)
+{
+	end();
+	this->DockManager = DockManager;
+	this->ExcludedContainer = ExcludedContainer;
+}
+
+
+//============================================================================
+void CDockDragSession::end()
+{
+	removeEventFilters();
+	Containers.clear();
+	DockManager.clear();
+	ExcludedContainer.clear();
+	Valid = false;
+}
+
+
+//============================================================================
+bool CDockDragSession::isActive() const
+{
+	return !DockManager.isNull();
+}
+
+
+//============================================================================
+void CDockDragSession::invalidate()
+{
+	Valid = false;
+}
+
+
+//============================================================================
+void CDockDragSession::removeEventFilters()
+{
+	for (const auto& Window : FilteredWindows)
+	{
+		if (Window)
+		{
+			Window->removeEventFilter(this);
+		}
+	}
+	FilteredWindows.clear();
+}
+
+
+//============================================================================
+void CDockDragSession::ensureCaptured()
+{
+	if (!DockManager)
+	{
+		return;
+	}
+
+	if (Valid && ContainersRevision == DockManager->dockContainersRevision())
+	{
+		return;
+	}
+
+	capture();
+}
+
+
+//============================================================================
+void CDockDragSession::capture()
+{
+	removeEventFilters();
+	Containers.clear();
+	ContainersRevision = DockManager->dockContainersRevision();
+	Valid = true;
+
+	QVector<unsigned int> ZOrder;
+	for (auto Container : DockManager->dockContainers())
+	{
+		if (!Container->isVisible() || Container == ExcludedContainer)
+		{
+			continue;
+		}
+
+		ContainerEntry Entry;
+		Entry.Container = Container;
+		Entry.GlobalRect = QRect(Container->mapToGlobal(QPoint(0, 0)), Container->size());
+		Containers.append(Entry);
+
+		// Moving, resizing, hiding or activating any captured window
+		// changes the geometry or the z-order of the snapshot
+		QWidget* Window = Container->window();
+		if (!FilteredWindows.contains(Window))
+		{
+			Window->installEventFilter(this);
+			FilteredWindows.append(Window);
+		}
+	}
+
+	std::stable_sort(Containers.begin(), Containers.end(),
+		[](const ContainerEntry& a, const ContainerEntry& b)
+		{
+			return a.Container->zOrderIndex() > b.Container->zOrderIndex();
+		});
+}
+
+
+//============================================================================
+CDockContainerWidget* CDockDragSession::containerAt(const QPoint& GlobalPos)
+{
+	ensureCaptured();
+	for (const auto& Entry : Containers)
+	{
+		if (Entry.GlobalRect.contains(GlobalPos))
+		{
+			if (!Entry.Container)
+			{
+				invalidate();
+				return nullptr;
+			}
+			return Entry.Container;
+		}
+	}
+	return nullptr;
+}
+
+
+//============================================================================
+CDockAreaWidget* CDockDragSession::dockAreaAt(CDockContainerWidget* Container,
+	const QPoint& GlobalPos)
+{
+	// The container keeps its own hit test index up to date, so the
+	// snapshot does not duplicate the dock area geometry
+	return Container ? Container->dockAreaAt(GlobalPos) : nullptr;
+}
+
+
+//============================================================================
+bool CDockDragSession::eventFilter(QObject* Object, QEvent* Event)
+{
+	switch (Event->type())
+	{
+	case QEvent::Move:
+	case QEvent::Resize:
+	case QEvent::Show:
+	case QEvent::Hide:
+	case QEvent::WindowActivate:
+		 invalidate();
+		 break;
+
+	default:
+		break;
+	}
+	return QObject::eventFilter(Object, Event);
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockDragSession.cpp
@@ -0,0 +1,124 @@
+#ifndef DockDragSessionH
+#define DockDragSessionH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockDragSession.h
+/// \date   16.10.2026
+/// \brief  Declaration of CDockDragSession
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "ads_globals.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QRect>
+#include <QVector>
+
+namespace ads
+{
+class CDockManager;
+class CDockContainerWidget;
+class CDockAreaWidget;
+
+/**
+ * Snapshot of the drop targets of a drag operation.
+ * When the session begins, it captures the global rectangles and the
+ * z-order of all visible dock containers. Container hit tests of the drag
+ * are answered from this snapshot, without walking the container list and
+ * without mapping the cursor position for each container on every mouse
+ * move. Dock area hit tests use the splitter index of the container.
+ * The snapshot is recaptured lazily, if a container is registered or
+ * removed, or if a window of a captured container moves, resizes, is shown,
+ * hidden or activated during the drag.
+ */
+class ADS_EXPORT CDockDragSession : public QObject
+{
+public:
+	CDockDragSession();
+	virtual ~CDockDragSession();
+
+	/**
+	 * Starts a session for the containers of the given dock manager.
+	 * The ExcludedContainer is ignored for all hit tests - this is the
+	 * container of a dragged floating widget.
+	 */
+	void begin(CDockManager* DockManager, CDockContainerWidget* ExcludedContainer = nullptr);
+
+	/**
+	 * Ends the session and releases the snapshot
+	 */
+	void end();
+
+	/**
+	 * Returns true between begin() and end()
+	 */
+	bool isActive() const;
+
+	/**
+	 * Marks the snapshot as outdated. It is recaptured by the next hit test.
+	 */
+	void invalidate();
+
+	/**
+	 * Returns the top most container that contains the given global
+	 * position or nullptr
+	 */
+	CDockContainerWidget* containerAt(const QPoint& GlobalPos);
+
+	/**
+	 * Returns the visible dock area of the given container that contains
+	 * the given global position or nullptr.
+	 * This is a binary search in the cached splitter index of the container.
+	 */
+	CDockAreaWidget* dockAreaAt(CDockContainerWidget* Container, const QPoint& GlobalPos);
+
+protected:
+	virtual bool eventFilter(QObject* Object, QEvent* Event) override;
+
+private:
+	struct ContainerEntry
+	{
+		QPointer<CDockContainerWidget> Container;
+		QRect GlobalRect;
+	};
+
+	/**
+	 * Recaptures the snapshot, if it is outdated
+	 */
+	void ensureCaptured();
+	void capture();
+	void removeEventFilters();
+
+	QPointer<CDockManager> DockManager;
+	QPointer<CDockContainerWidget> ExcludedContainer;
+	QVector<ContainerEntry> Containers;///< sorted from front to back
+	QVector<QPointer<QWidget>> FilteredWindows;
+	int ContainersRevision = -1;
+	bool Valid = false;
+};
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockDragSessionH
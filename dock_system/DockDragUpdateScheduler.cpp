@@ -0,0 +1,140 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockDragUpdateScheduler.cpp
+/// \date   16.10.2026
+/// \brief  Implementation of CDockDragUpdateScheduler
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockDragUpdateScheduler.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+#include <QWindow>
+
+namespace ads
+{
+//============================================================================
+CDockDragUpdateScheduler::CDockDragUpdateScheduler(QWidget* Widget,
+	tUpdateFunction Update)
+	: Widget(Widget),
+	  Update(std::move(Update))
+{
+	Timer.setSingleShot(true);
+	Timer.setTimerType(Qt::PreciseTimer);
+	QObject::connect(&Timer, &QTimer::timeout, [this]()
+	{
+		run();
+	});
+}
+
+
+//============================================================================
+int CDockDragUpdateScheduler::frameInterval() const
+{
+	QScreen* Screen = nullptr;
+	if (Widget && Widget->windowHandle())
+	{
+		Screen = Widget->windowHandle()->screen();
+	}
+	if (!Screen)
+	{
+		Screen = QGuiApplication::primaryScreen();
+	}
+
+	qreal RefreshRate = Screen ? Screen->refreshRate() : 60;
+	if (RefreshRate < 1)
+	{
+		RefreshRate = 60;
+	}
+	return qMax(1, qRound(1000 / RefreshRate));
+}
+
+
+//============================================================================
+void CDockDragUpdateScheduler::schedule(const QPoint& GlobalPos)
+{
+	Pos = GlobalPos;
+	Pending = true;
+	if (Timer.isActive())
+	{
+		return;
+	}
+
+	int Interval = frameInterval();
+	qint64 Elapsed = LastUpdate.isValid() ? LastUpdate.elapsed() : Interval;
+	if (Elapsed >= Interval)
+	{
+		run();
+	}
+	else
+	{
+		Timer.start(Interval - static_cast<int>(Elapsed));
+	}
+}
+
+
+//============================================================================
+void CDockDragUpdateScheduler::flush()
+{
+	Timer.stop();
+	if (Pending)
+	{
+		run();
+	}
+}
+
+
+//============================================================================
+void CDockDragUpdateScheduler::cancel()
+{
+	Timer.stop();
+	Pending = false;
+}
+
+
+//============================================================================
+bool CDockDragUpdateScheduler::isPending() const
+{
+	return Pending;
+}
+
+
+//============================================================================
+void CDockDragUpdateScheduler::run()
+{
+	if (!Pending)
+	{
+		return;
+	}
+
+	Pending = false;
+	LastUpdate.start();
+	Update(Pos);
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockDragUpdateScheduler.cpp
@@ -0,0 +1,107 @@
+#ifndef DockDragUpdateSchedulerH
+#define DockDragUpdateSchedulerH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockDragUpdateScheduler.h
+/// \date   16.10.2026
+/// \brief  Declaration of CDockDragUpdateScheduler
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "ads_globals.h"
+
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QTimer>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(QWidget)
+
+namespace ads
+{
+/**
+ * Coalesces the drop overlay updates of a drag operation.
+ * Mouse move events may arrive much faster than the display refreshes.
+ * The scheduler runs the update function at most once per display frame
+ * of the screen of the dragged widget and always with the latest cursor
+ * position. The first move after an idle frame is evaluated immediately,
+ * all further moves within the same frame are merged into one trailing
+ * update at the start of the next frame.
+ */
+class ADS_EXPORT CDockDragUpdateScheduler
+{
+public:
+	using tUpdateFunction = std::function<void(const QPoint&)>;
+
+	/**
+	 * Creates a scheduler that calls Update for the dragged Widget
+	 */
+	CDockDragUpdateScheduler(QWidget* Widget, tUpdateFunction Update);
+
+	/**
+	 * Requests an update for the given global cursor position
+	 */
+	void schedule(const QPoint& GlobalPos);
+
+	/**
+	 * Runs a pending update immediately. Call this before the drop target
+	 * is evaluated, so that the drop uses the latest cursor position.
+	 */
+	void flush();
+
+	/**
+	 * Discards a pending update
+	 */
+	void cancel();
+
+	/**
+	 * Returns true, if an update is pending
+	 */
+	bool isPending() const;
+
+private:
+	Q_DISABLE_COPY(CDockDragUpdateScheduler)
+
+	/**
+	 * Returns the frame interval of the screen of the dragged widget in ms
+	 */
+	int frameInterval() const;
+
+	/**
+	 * Runs the update with the latest position
+	 */
+	void run();
+
+	QWidget* Widget;
+	tUpdateFunction Update;
+	QTimer Timer;
+	QElapsedTimer LastUpdate;
+	QPoint Pos;
+	bool Pending = false;
+};
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockDragUpdateSchedulerH
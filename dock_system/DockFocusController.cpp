@@ -65,6 +65,14 @@ static void updateDockWidgetFocusStyle(CDockWidget* DockWidget, bool Focused)
 {
 	DockWidget->setProperty("focused", Focused);
 	DockWidget->tabWidget()->setProperty("focused", Focused);
+	// In painted mode the tab paints the focus highlight from the property.
+	// Repolishing the dock widget would also repolish the complete content
+	// widget subtree on every focus change.
+	if (CDockManager::testConfigFlag(CDockManager::PaintedFocusHighlighting))
+	{
+		DockWidget->tabWidget()->updateFocusHighlight();
+		return;
+	}
 	DockWidget->tabWidget()->updateStyle();
 	internal::repolishStyle(DockWidget);
 }
@@ -74,6 +82,11 @@ static void updateDockWidgetFocusStyle(CDockWidget* DockWidget, bool Focused)
 static void updateDockAreaFocusStyle(CDockAreaWidget* DockArea, bool Focused)
 {
 	DockArea->setProperty("focused", Focused);
+	if (CDockManager::testConfigFlag(CDockManager::PaintedFocusHighlighting))
+	{
+		DockArea->titleBar()->update();
+		return;
+	}
 	internal::repolishStyle(DockArea);
 	internal::repolishStyle(DockArea->titleBar());
 }
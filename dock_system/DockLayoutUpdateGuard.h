@@ -0,0 +1,72 @@
+#ifndef DockLayoutUpdateGuardH
+#define DockLayoutUpdateGuardH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockLayoutUpdateGuard.h
+/// \date   16.10.2026
+/// \brief  Declaration of CDockLayoutUpdateGuard
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockManager.h"
+
+namespace ads
+{
+/**
+ * RAII guard for layout update transactions of the dock manager.
+ * The constructor calls CDockManager::beginLayoutUpdate() and the
+ * destructor calls CDockManager::endLayoutUpdate(). Guards may be nested -
+ * the deferred updates are applied when the outermost guard is destroyed.
+ * \code
+ * {
+ *     CDockLayoutUpdateGuard Guard(DockManager);
+ *     for (auto DockWidget : DockWidgets)
+ *     {
+ *         DockManager->addDockWidget(RightDockWidgetArea, DockWidget);
+ *     }
+ * }
+ * \endcode
+ */
+class CDockLayoutUpdateGuard
+{
+public:
+	explicit CDockLayoutUpdateGuard(CDockManager* DockManager)
+		: DockManager(DockManager)
+	{
+		DockManager->beginLayoutUpdate();
+	}
+
+	~CDockLayoutUpdateGuard()
+	{
+		DockManager->endLayoutUpdate();
+	}
+
+private:
+	Q_DISABLE_COPY(CDockLayoutUpdateGuard)
+	CDockManager* DockManager;
+};
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockLayoutUpdateGuardH
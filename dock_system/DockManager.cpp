@@ -37,14 +37,15 @@
 #include <QMainWindow>
 #include <QList>
 #include <QMap>
+#include <QHash>
 #include <QVariant>
 #include <QDebug>
 #include <QFile>
 #include <QAction>
-#include <QXmlStreamWriter>
 #include <QSettings>
 #include <QMenu>
 #include <QApplication>
+#include <QThreadPool>
 
 #include "FloatingDockContainer.h"
 #include "DockOverlay.h"
@@ -52,9 +53,12 @@
 #include "ads_globals.h"
 #include "DockAreaWidget.h"
 #include "IconProvider.h"
-#include "DockingStateReader.h"
+#include "DockStateSerializer.h"
+#include "DockPersistenceJob.h"
 #include "DockAreaTitleBar.h"
 #include "DockFocusController.h"
+#include "DockTrace.h"
+#include "DockMetrics.h"
 
 #ifdef Q_OS_LINUX
 #include "linux/FloatingWidgetTitleBar.h"
@@ -89,6 +93,7 @@ enum eStateFileVersion
 };
 
 static CDockManager::ConfigFlags StaticConfigFlags = CDockManager::DefaultNonOpaqueConfig;
+static int StaticContentSuspendDelay = 500;
 
 /**
  * Private data class of CDockManager class (pimpl)
@@ -98,10 +103,17 @@ struct DockManagerPrivate
 	CDockManager* _this;
 	QList<CFloatingDockContainer*> FloatingWidgets;
 	QList<CDockContainerWidget*> Containers;
+	int ContainersRevision = 0;///< incremented on each container list change
 	CDockOverlay* ContainerOverlay;
 	CDockOverlay* DockAreaOverlay;
 	QMap<QString, CDockWidget*> DockWidgetsMap;
 	QMap<QString, QByteArray> Perspectives;
+	QHash<QString, DockLayoutState> PerspectiveCache;
+	// The pool is declared after the receiver, so it is destroyed first and
+	// waits for all running jobs while the receiver still exists
+	CDockPersistenceJobReceiver PersistenceReceiver;
+	QThreadPool PersistencePool;
+	int LayoutUpdateDepth = 0;
 	QMap<QString, QMenu*> ViewMenuGroups;
 	QMenu* ViewMenu;
 	CDockManager::eViewMenuInsertionOrder MenuInsertionOrder = CDockManager::MenuAlphabeticallySorted;
@@ -117,20 +129,78 @@ struct DockManagerPrivate
 	DockManagerPrivate(CDockManager* _public);
 
 	/**
-	 * Checks if the given data stream is a valid docking system state
-	 * file.
+	 * Parses the given binary, XML or compressed XML state data in a single
+	 * pass into the layout tree
 	 */
-	bool checkFormat(const QByteArray &state, int version);
+	bool parseState(const QByteArray &state, DockLayoutState& Layout);
 
 	/**
-	 * Restores the state
+	 * Restore state.
+	 * If Incremental is true and the layout allows it, the existing dock
+	 * areas and splitters are reused and only the differences to the
+	 * current layout are applied.
 	 */
-	bool restoreStateFromXml(const QByteArray &state, int version, bool Testing = internal::Restore);
+	bool restoreState(const QByteArray &state, int version, bool Incremental = false);
 
 	/**
-	 * Restore state
+	 * Restores the given parsed and checked layout. If Layout is a nullptr,
+	 * the state was invalid and only the restore signals are emitted.
+	 * \see restoreState()
 	 */
-	bool restoreState(const QByteArray &state, int version);
+	bool restoreLayoutState(const DockLayoutState* Layout, bool Incremental);
+
+	/**
+	 * Captures the current layout of all containers into the layout tree
+	 */
+	void captureLayout(DockLayoutState& Layout, int version) const;
+
+	/**
+	 * Returns the pre-parsed and validated layout of the perspective with
+	 * the given name. The perspective is parsed on first access.
+	 * Returns a nullptr if the perspective does not exist or if its state
+	 * is invalid.
+	 */
+	const DockLayoutState* cachedPerspective(const QString& Name);
+
+	/**
+	 * The validation of cached perspectives depends on the central widget -
+	 * so the cache needs to be cleared if it changes
+	 */
+	void invalidatePerspectiveCache()
+	{
+		PerspectiveCache.clear();
+	}
+
+	/**
+	 * Starts the given persistence job on the worker thread. The Finished
+	 * function is called on the GUI thread when the job is done, if the
+	 * dock manager still exists.
+	 */
+	void startPersistenceJob(CDockPersistenceJob* Job,
+		std::function<void(CDockPersistenceJob*)> Finished)
+	{
+		Job->Receiver = &PersistenceReceiver;
+		Job->Finished = Finished;
+		PersistencePool.start(Job);
+	}
+
+	/**
+	 * Builds the dock widget layout from the parsed and checked layout tree
+	 */
+	void applyLayout(const DockLayoutState& Layout);
+
+	/**
+	 * Applies the parsed and checked layout tree to the existing dock
+	 * areas and splitters
+	 */
+	void applyLayoutIncremental(const DockLayoutState& Layout);
+
+	/**
+	 * Returns true, if the given layout can be applied incrementally.
+	 * This requires the same containers as the current layout and that
+	 * no dock widget moves into another container.
+	 */
+	bool canRestoreIncrementally(const DockLayoutState& Layout) const;
 
 	void restoreDockWidgetsOpenState();
 	void restoreDockAreasIndices();
@@ -154,9 +224,20 @@ struct DockManagerPrivate
 	}
 
 	/**
-	 * Restores the container with the given index
+	 * Restores the container with the given index from a parsed layout
 	 */
-	bool restoreContainer(int Index, CDockingStateReader& stream, bool Testing);
+	void restoreContainer(int Index, const DockLayoutContainer& State);
+
+	/**
+	 * Checks if the parsed layout matches the given user version and the
+	 * central widget of this dock manager
+	 */
+	bool checkLayout(const DockLayoutState& Layout, int version) const;
+
+	/**
+	 * Restores all containers from the parsed and checked layout
+	 */
+	void restoreLayout(const DockLayoutState& Layout);
 
 	/**
 	 * Loads the stylesheet
@@ -174,7 +255,9 @@ struct DockManagerPrivate
 DockManagerPrivate::DockManagerPrivate(CDockManager* _public) :
 	_this(_public)
 {
-
+	// A single worker thread ensures, that persistence jobs for the same
+	// file are executed in the order they have been started
+	PersistencePool.setMaxThreadCount(1);
 }
 
 
@@ -184,8 +267,11 @@ void DockManagerPrivate::loadStylesheet()
 	initResource();
 	QString Result;
 	QString FileName = ":/ads/stylesheets/";
-	FileName += CDockManager::testConfigFlag(CDockManager::FocusHighlighting)
-		? "focus_highlighting" : "default";
+	// The painted focus highlighting must not use the focus style sheet
+	// because its rules only take effect after a repolish
+	bool FocusStyleSheet = CDockManager::testConfigFlag(CDockManager::FocusHighlighting)
+		&& !CDockManager::testConfigFlag(CDockManager::PaintedFocusHighlighting);
+	FileName += FocusStyleSheet ? "focus_highlighting" : "default";
 #ifdef Q_OS_LINUX
     FileName += "_linux";
 #endif
@@ -195,139 +281,87 @@ void DockManagerPrivate::loadStylesheet()
 	QTextStream StyleSheetStream(&StyleSheetFile);
 	Result = StyleSheetStream.readAll();
 	StyleSheetFile.close();
+	CDockMetrics::increment(StyleSheetSets);
 	_this->setStyleSheet(Result);
 }
 
 
 //============================================================================
-bool DockManagerPrivate::restoreContainer(int Index, CDockingStateReader& stream, bool Testing)
+void DockManagerPrivate::restoreContainer(int Index, const DockLayoutContainer& State)
 {
-	if (Testing)
+	if (Index >= Containers.count())
 	{
-		Index = 0;
+		CFloatingDockContainer* FloatingWidget = new CFloatingDockContainer(_this);
+		FloatingWidget->restoreState(State);
+		return;
 	}
 
-	bool Result = false;
-	if (Index >= Containers.count())
+	auto Container = Containers[Index];
+	if (Container->isFloating())
 	{
-		CFloatingDockContainer* FloatingWidget = new CFloatingDockContainer(_this);
-		Result = FloatingWidget->restoreState(stream, Testing);
+		Container->floatingWidget()->restoreState(State);
 	}
 	else
 	{
-        ADS_PRINT("d->Containers[i]->restoreState ");
-		auto Container = Containers[Index];
-		if (Container->isFloating())
-		{
-			Result = Container->floatingWidget()->restoreState(stream, Testing);
-		}
-		else
-		{
-			Result = Container->restoreState(stream, Testing);
-		}
+		Container->restoreState(State);
 	}
-
-	return Result;
-}
-
-
-//============================================================================
-bool DockManagerPrivate::checkFormat(const QByteArray &state, int version)
-{
-    return restoreStateFromXml(state, version, internal::RestoreTesting);
 }
 
 
 //============================================================================
-bool DockManagerPrivate::restoreStateFromXml(const QByteArray &state,  int version,
-	bool Testing)
+bool DockManagerPrivate::checkLayout(const DockLayoutState& Layout, int version) const
 {
-	Q_UNUSED(version);
+	if (Layout.Version > CurrentVersion)
+	{
+		return false;
+	}
 
-    if (state.isEmpty())
-    {
-        return false;
-    }
-    CDockingStateReader s(state);
-    s.readNextStartElement();
-    if (s.name() != "QtAdvancedDockingSystem")
-    {
-    	return false;
-    }
-    ADS_PRINT(s.attributes().value("Version"));
-    bool ok;
-    int v = s.attributes().value("Version").toInt(&ok);
-    if (!ok || v > CurrentVersion)
-    {
-    	return false;
-    }
-    s.setFileVersion(v);
+	if (Layout.HasUserVersion && Layout.UserVersion != version)
+	{
+		return false;
+	}
 
-    ADS_PRINT(s.attributes().value("UserVersion"));
-    // Older files do not support UserVersion but we still want to load them so
-    // we first test if the attribute exists
-    if (!s.attributes().value("UserVersion").isEmpty())
-    {
-		v = s.attributes().value("UserVersion").toInt(&ok);
-		if (!ok || v != version)
-		{
-			return false;
-		}
-    }
+	if (!CentralWidget)
+	{
+		return true;
+	}
 
-    bool Result = true;
-#ifdef ADS_DEBUG_PRINT
-    int  DockContainers = s.attributes().value("Containers").toInt();
-#endif
-    ADS_PRINT(DockContainers);
+	// If we have a central widget but a state without central widget, then
+	// something is wrong.
+	if (Layout.CentralWidget.isEmpty())
+	{
+		qWarning() << "Dock manager has central widget but saved state does not have central widget.";
+		return false;
+	}
 
-    if (CentralWidget)
-    {
-		const auto CentralWidgetAttribute = s.attributes().value("CentralWidget");
-		// If we have a central widget but a state without central widget, then
-		// something is wrong.
-		if (CentralWidgetAttribute.isEmpty())
-		{
-			qWarning() << "Dock manager has central widget but saved state does not have central widget.";
-			return false;
-		}
+	// If the object name of the central widget does not match the name of the
+	// saved central widget, the something is wrong
+	if (CentralWidget->objectName() != Layout.CentralWidget)
+	{
+		qWarning() << "Object name of central widget does not match name of central widget in saved state.";
+		return false;
+	}
 
-		// If the object name of the central widget does not match the name of the
-		// saved central widget, the something is wrong
-		if (CentralWidget->objectName() != CentralWidgetAttribute.toString())
-		{
-			qWarning() << "Object name of central widget does not match name of central widget in saved state.";
-			return false;
-		}
-    }
+	return true;
+}
 
-    int DockContainerCount = 0;
-    while (s.readNextStartElement())
-    {
-    	if (s.name() == "Container")
-    	{
-    		Result = restoreContainer(DockContainerCount, s, Testing);
-			if (!Result)
-			{
-				break;
-			}
-			DockContainerCount++;
-    	}
-    }
 
-    if (!Testing)
-    {
-		// Delete remaining empty floating widgets
-		int FloatingWidgetIndex = DockContainerCount - 1;
-		for (int i = FloatingWidgetIndex; i < FloatingWidgets.count(); ++i)
-		{
-			auto* floatingWidget = FloatingWidgets[i];
-			_this->removeDockContainer(floatingWidget->dockContainer());
-			floatingWidget->deleteLater();
-		}
-    }
+//============================================================================
+void DockManagerPrivate::restoreLayout(const DockLayoutState& Layout)
+{
+	for (int i = 0; i < Layout.Containers.count(); ++i)
+	{
+		restoreContainer(i, Layout.Containers[i]);
+	}
 
-    return Result;
+	// Delete remaining empty floating widgets
+	int FloatingWidgetIndex = Layout.Containers.count() - 1;
+	for (int i = FloatingWidgetIndex; i < FloatingWidgets.count(); ++i)
+	{
+		auto* floatingWidget = FloatingWidgets[i];
+		_this->removeDockContainer(floatingWidget->dockContainer());
+		internal::deleteLater(floatingWidget);
+	}
 }
 
 
@@ -418,31 +452,243 @@ void DockManagerPrivate::emitTopLevelEvents()
 
 
 //============================================================================
-bool DockManagerPrivate::restoreState(const QByteArray& State, int version)
+bool DockManagerPrivate::parseState(const QByteArray& State, DockLayoutState& Layout)
 {
-	QByteArray state = State.startsWith("<?xml") ? State : qUncompress(State);
-    if (!checkFormat(state, version))
-    {
-        ADS_PRINT("checkFormat: Error checking format!!!!!!!");
-    	return false;
-    }
+	return CDockStateSerializer::readState(State, Layout);
+}
 
+
+//============================================================================
+void DockManagerPrivate::applyLayout(const DockLayoutState& Layout)
+{
+	ADS_TRACE_SCOPE("DockManagerPrivate::applyLayout");
     // Hide updates of floating widgets from use
     hideFloatingWidgets();
     markDockWidgetsDirty();
-
-    if (!restoreStateFromXml(state, version))
-    {
-        ADS_PRINT("restoreState: Error restoring state!!!!!!!");
-    	return false;
-    }
-
+    restoreLayout(Layout);
     restoreDockWidgetsOpenState();
     restoreDockAreasIndices();
     emitTopLevelEvents();
     _this->dumpLayout();
+}
+
+
+//============================================================================
+bool DockManagerPrivate::canRestoreIncrementally(const DockLayoutState& Layout) const
+{
+	if (Layout.Containers.count() != Containers.count())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < Containers.count(); ++i)
+	{
+		const auto& Container = Layout.Containers[i];
+		if (Container.Floating != Containers[i]->isFloating())
+		{
+			return false;
+		}
+
+		for (const auto& Node : Container.Nodes)
+		{
+			if (Node.Type != DockLayoutNode::WidgetNode)
+			{
+				continue;
+			}
+
+			auto DockWidget = DockWidgetsMap.value(Node.Name, nullptr);
+			auto DockContainer = DockWidget ? DockWidget->dockContainer() : nullptr;
+			if (DockContainer && DockContainer != Containers[i])
+			{
+				return false;
+			}
+		}
+	}
 
-    return true;
+	return true;
+}
+
+
+//============================================================================
+void DockManagerPrivate::applyLayoutIncremental(const DockLayoutState& Layout)
+{
+	ADS_TRACE_SCOPE("DockManagerPrivate::applyLayoutIncremental");
+	// Remember the placement of all dock widgets to detect the dock widgets
+	// that are not affected by the new layout
+	struct DockWidgetPlacement
+	{
+		CDockAreaWidget* DockArea;
+		int Index;
+		bool Closed;
+	};
+	QHash<CDockWidget*, DockWidgetPlacement> Placements;
+	for (auto DockWidget : DockWidgetsMap)
+	{
+		auto DockArea = DockWidget->dockAreaWidget();
+		Placements.insert(DockWidget, {DockArea,
+			DockArea ? DockArea->index(DockWidget) : -1, DockWidget->isClosed()});
+	}
+
+	markDockWidgetsDirty();
+	for (int i = 0; i < Layout.Containers.count(); ++i)
+	{
+		auto Container = Containers[i];
+		if (Container->isFloating())
+		{
+			Container->floatingWidget()->restoreStateIncremental(Layout.Containers[i]);
+		}
+		else
+		{
+			Container->restoreStateIncremental(Layout.Containers[i]);
+		}
+	}
+
+	// Only dock widgets that changed their dock area, position or open state
+	// need to be toggled. Toggling unchanged dock widgets would switch the
+	// current widget of their dock area back and forth.
+	for (auto DockWidget : DockWidgetsMap)
+	{
+		const auto& Placement = Placements[DockWidget];
+		if (DockWidget->property(internal::DirtyProperty).toBool())
+		{
+			if (Placement.DockArea)
+			{
+				DockWidget->flagAsUnassigned();
+				emit DockWidget->viewToggled(false);
+			}
+			continue;
+		}
+
+		bool Closed = DockWidget->property(internal::ClosedProperty).toBool();
+		auto DockArea = DockWidget->dockAreaWidget();
+		if (Placement.DockArea == DockArea && Placement.Closed == Closed
+		 && Placement.Index == DockArea->index(DockWidget))
+		{
+			continue;
+		}
+		DockWidget->toggleViewInternal(!Closed);
+	}
+
+	restoreDockAreasIndices();
+	emitTopLevelEvents();
+	_this->dumpLayout();
+}
+
+
+//============================================================================
+void DockManagerPrivate::captureLayout(DockLayoutState& Layout, int version) const
+{
+	Layout.Version = CurrentVersion;
+	Layout.UserVersion = version;
+	if (CentralWidget)
+	{
+		Layout.CentralWidget = CentralWidget->objectName();
+	}
+	Layout.Containers.resize(Containers.count());
+	for (int i = 0; i < Containers.count(); ++i)
+	{
+		Containers[i]->saveState(Layout.Containers[i]);
+	}
+}
+
+
+//============================================================================
+const DockLayoutState* DockManagerPrivate::cachedPerspective(const QString& Name)
+{
+	auto CacheIterator = PerspectiveCache.constFind(Name);
+	if (CacheIterator != PerspectiveCache.constEnd())
+	{
+		return &CacheIterator.value();
+	}
+
+	const auto Iterator = Perspectives.constFind(Name);
+	if (Iterator == Perspectives.constEnd())
+	{
+		return nullptr;
+	}
+
+	DockLayoutState Layout;
+	if (!parseState(Iterator.value(), Layout) || !checkLayout(Layout, 0))
+	{
+		return nullptr;
+	}
+
+	return &PerspectiveCache.insert(Name, Layout).value();
+}
+
+
+//============================================================================
+bool DockManagerPrivate::restoreState(const QByteArray& State, int version,
+	bool Incremental)
+{
+	ADS_TRACE_SCOPE("CDockManager::restoreState");
+	// Prevent multiple calls as long as state is not restore. This may
+	// happen, if QApplication::processEvents() is called somewhere
+	if (RestoringState)
+	{
+		return false;
+	}
+
+	// The state is parsed and validated only once into the layout tree.
+	// Building the widgets from a validated tree can not fail, so there is
+	// no need for a separate testing pass.
+	DockLayoutState Layout;
+	bool Result;
+	{
+		ADS_TRACE_SCOPE("DockManagerPrivate::parseState");
+		Result = parseState(State, Layout) && checkLayout(Layout, version);
+	}
+	if (!Result)
+	{
+		ADS_PRINT("checkFormat: Error checking format!!!!!!!");
+	}
+
+	return restoreLayoutState(Result ? &Layout : nullptr, Incremental);
+}
+
+
+//============================================================================
+bool DockManagerPrivate::restoreLayoutState(const DockLayoutState* Layout,
+	bool Incremental)
+{
+	if (RestoringState)
+	{
+		return false;
+	}
+
+	Incremental = Layout && Incremental && canRestoreIncrementally(*Layout);
+
+	// We hide the complete dock manager here. Restoring the state means
+	// that DockWidgets are removed from the DockArea internal stack layout
+	// which in turn  means, that each time a widget is removed the stack
+	// will show and raise the next available widget which in turn
+	// triggers show events for the dock widgets. To avoid this we hide the
+	// dock manager. Because there will be no processing of application
+	// events until this function is finished, the user will not see this
+	// hiding. An incremental restore keeps all unchanged dock widgets in
+	// place, so there is no need to hide the dock manager.
+	bool Hide = !_this->isHidden() && !Incremental;
+	if (Hide)
+	{
+		_this->hide();
+	}
+	RestoringState = true;
+	emit _this->restoringState();
+	if (Incremental)
+	{
+		applyLayoutIncremental(*Layout);
+	}
+	else if (Layout)
+	{
+		applyLayout(*Layout);
+	}
+	RestoringState = false;
+	if (Hide)
+	{
+		_this->show();
+	}
+	emit _this->stateRestored();
+	return Layout != nullptr;
 }
 
 
@@ -594,6 +840,7 @@ void CDockManager::removeFloatingWidget(CFloatingDockContainer* FloatingWidget)
 void CDockManager::registerDockContainer(CDockContainerWidget* DockContainer)
 {
 	d->Containers.append(DockContainer);
+	d->ContainersRevision++;
 }
 
 
@@ -603,10 +850,18 @@ void CDockManager::removeDockContainer(CDockContainerWidget* DockContainer)
 	if (this != DockContainer)
 	{
 		d->Containers.removeAll(DockContainer);
+		d->ContainersRevision++;
 	}
 }
 
 
+//============================================================================
+int CDockManager::dockContainersRevision() const
+{
+	return d->ContainersRevision;
+}
+
+
 //============================================================================
 CDockOverlay* CDockManager::containerOverlay() const
 {
@@ -645,65 +900,75 @@ unsigned int CDockManager::zOrderIndex() const
 //============================================================================
 QByteArray CDockManager::saveState(int version) const
 {
-    QByteArray xmldata;
-    QXmlStreamWriter s(&xmldata);
-    auto ConfigFlags = CDockManager::configFlags();
-	s.setAutoFormatting(ConfigFlags.testFlag(XmlAutoFormattingEnabled));
-    s.writeStartDocument();
-		s.writeStartElement("QtAdvancedDockingSystem");
-		s.writeAttribute("Version", QString::number(CurrentVersion));
-		s.writeAttribute("UserVersion", QString::number(version));
-		s.writeAttribute("Containers", QString::number(d->Containers.count()));
-		if (d->CentralWidget)
-		{
-			s.writeAttribute("CentralWidget", d->CentralWidget->objectName());
-		}
-		for (auto Container : d->Containers)
-		{
-			Container->saveState(s);
-		}
+	// The XML and the binary data are both written from the layout tree, so
+	// the synchronous and the asynchronous save produce the same data
+	auto ConfigFlags = CDockManager::configFlags();
+	DockLayoutState Layout;
+	d->captureLayout(Layout, version);
+	return CDockStateSerializer::writeState(Layout,
+		ConfigFlags.testFlag(BinaryStateFormat),
+		ConfigFlags.testFlag(XmlCompressionEnabled),
+		ConfigFlags.testFlag(XmlAutoFormattingEnabled));
+}
 
-		s.writeEndElement();
-    s.writeEndDocument();
 
-    return ConfigFlags.testFlag(XmlCompressionEnabled)
-    	? qCompress(xmldata, 9) : xmldata;
+//============================================================================
+void CDockManager::saveStateAsync(const QString& FileName, int version)
+{
+	// Only the layout tree is captured on the GUI thread. Serialization,
+	// compression and file I/O are done on the worker thread.
+	auto ConfigFlags = CDockManager::configFlags();
+	auto Job = new CDockPersistenceJob(CDockPersistenceJob::SaveState, FileName);
+	d->captureLayout(Job->Layout, version);
+	Job->Binary = ConfigFlags.testFlag(BinaryStateFormat);
+	Job->Compress = ConfigFlags.testFlag(XmlCompressionEnabled);
+	Job->AutoFormatting = ConfigFlags.testFlag(XmlAutoFormattingEnabled);
+	d->startPersistenceJob(Job, [this](CDockPersistenceJob* Job)
+	{
+		emit stateSaved(Job->FileName, Job->Ok);
+	});
 }
 
 
 //============================================================================
 bool CDockManager::restoreState(const QByteArray &state, int version)
 {
-	// Prevent multiple calls as long as state is not restore. This may
-	// happen, if QApplication::processEvents() is called somewhere
-	if (d->RestoringState)
+	return d->restoreState(state, version);
+}
+
+
+//============================================================================
+void CDockManager::beginLayoutUpdate()
+{
+	++d->LayoutUpdateDepth;
+}
+
+
+//============================================================================
+void CDockManager::endLayoutUpdate()
+{
+	if (d->LayoutUpdateDepth <= 0)
 	{
-		return false;
+		return;
 	}
 
-	// We hide the complete dock manager here. Restoring the state means
-	// that DockWidgets are removed from the DockArea internal stack layout
-	// which in turn  means, that each time a widget is removed the stack
-	// will show and raise the next available widget which in turn
-	// triggers show events for the dock widgets. To avoid this we hide the
-	// dock manager. Because there will be no processing of application
-	// events until this function is finished, the user will not see this
-	// hiding
-	bool IsHidden = this->isHidden();
-	if (!IsHidden)
+	// Only the outermost transaction applies the deferred updates
+	if (--d->LayoutUpdateDepth > 0)
 	{
-		hide();
+		return;
 	}
-	d->RestoringState = true;
-	emit restoringState();
-	bool Result = d->restoreState(state, version);
-	d->RestoringState = false;
-	if (!IsHidden)
+
+	for (auto Container : d->Containers)
 	{
-		show();
+		Container->applyDeferredLayoutUpdates();
 	}
-	emit stateRestored();
-	return Result;
+}
+
+
+//============================================================================
+bool CDockManager::isLayoutUpdating() const
+{
+	return d->LayoutUpdateDepth > 0;
 }
 
 
@@ -819,6 +1084,11 @@ QMap<QString, CDockWidget*> CDockManager::dockWidgetsMap() const
 void CDockManager::addPerspective(const QString& UniquePrespectiveName)
 {
 	d->Perspectives.insert(UniquePrespectiveName, saveState());
+	// The current layout is already known, so we can fill the cache without
+	// parsing the saved state again
+	DockLayoutState Layout;
+	d->captureLayout(Layout, 0);
+	d->PerspectiveCache.insert(UniquePrespectiveName, Layout);
 	emit perspectiveListChanged();
 }
 
@@ -837,6 +1107,7 @@ void CDockManager::removePerspectives(const QStringList& Names)
 	for (auto Name : Names)
 	{
 		Count += d->Perspectives.remove(Name);
+		d->PerspectiveCache.remove(Name);
 	}
 
 	if (Count)
@@ -857,14 +1128,23 @@ QStringList CDockManager::perspectiveNames() const
 //============================================================================
 void CDockManager::openPerspective(const QString& PerspectiveName)
 {
-	const auto Iterator = d->Perspectives.find(PerspectiveName);
-	if (d->Perspectives.end() == Iterator)
+	if (!d->Perspectives.contains(PerspectiveName))
 	{
 		return;
 	}
 
 	emit openingPerspective(PerspectiveName);
-	restoreState(Iterator.value());
+	// The restore emits signals and connected slots may modify the
+	// perspectives and rehash the cache - so we apply a copy of the cached
+	// layout. The copy is cheap because the node lists are implicitly shared.
+	const DockLayoutState* CachedLayout = d->cachedPerspective(PerspectiveName);
+	DockLayoutState Layout;
+	if (CachedLayout)
+	{
+		Layout = *CachedLayout;
+	}
+	d->restoreLayoutState(CachedLayout ? &Layout : nullptr,
+		testConfigFlag(IncrementalPerspectiveSwitch));
 	emit perspectiveOpened(PerspectiveName);
 }
 
@@ -872,44 +1152,58 @@ void CDockManager::openPerspective(const QString& PerspectiveName)
 //============================================================================
 void CDockManager::savePerspectives(QSettings& Settings) const
 {
-	Settings.beginWriteArray("Perspectives", d->Perspectives.size());
-	int i = 0;
-	for (auto it = d->Perspectives.constBegin(); it != d->Perspectives.constEnd(); ++it)
-	{
-		Settings.setArrayIndex(i);
-		Settings.setValue("Name", it.key());
-		Settings.setValue("State", it.value());
-		++i;
-	}
-	Settings.endArray();
+	CDockPersistenceJob::writePerspectives(Settings, d->Perspectives);
 }
 
 
 //============================================================================
-void CDockManager::loadPerspectives(QSettings& Settings)
+void CDockManager::savePerspectivesAsync(const QString& FileName)
 {
-	d->Perspectives.clear();
-	int Size = Settings.beginReadArray("Perspectives");
-	if (!Size)
+	// The perspectives are already serialized - copying the map is cheap
+	// because of implicit sharing
+	auto Job = new CDockPersistenceJob(CDockPersistenceJob::SavePerspectives,
+		FileName);
+	Job->Perspectives = d->Perspectives;
+	d->startPersistenceJob(Job, [this](CDockPersistenceJob* Job)
 	{
-		Settings.endArray();
-		return;
-	}
+		emit perspectivesSaved(Job->FileName, Job->Ok);
+	});
+}
 
-	for (int i = 0; i < Size; ++i)
+
+//============================================================================
+void CDockManager::loadPerspectivesAsync(const QString& FileName)
+{
+	auto Job = new CDockPersistenceJob(CDockPersistenceJob::LoadPerspectives,
+		FileName);
+	d->startPersistenceJob(Job, [this](CDockPersistenceJob* Job)
 	{
-		Settings.setArrayIndex(i);
-		QString Name = Settings.value("Name").toString();
-		QByteArray Data = Settings.value("State").toByteArray();
-		if (Name.isEmpty() || Data.isEmpty())
+		// If loading failed, the current perspectives are kept
+		if (Job->Ok)
 		{
-			continue;
+			d->Perspectives = Job->Perspectives;
+			d->PerspectiveCache.clear();
+			// The perspectives have been parsed by the worker. Only the
+			// checks that depend on the dock widgets are left to do here.
+			for (auto it = Job->ParsedPerspectives.constBegin();
+				it != Job->ParsedPerspectives.constEnd(); ++it)
+			{
+				if (d->checkLayout(it.value(), 0))
+				{
+					d->PerspectiveCache.insert(it.key(), it.value());
+				}
+			}
 		}
+		emit perspectivesLoaded(Job->FileName, Job->Ok);
+	});
+}
 
-		d->Perspectives.insert(Name, Data);
-	}
 
-	Settings.endArray();
+//============================================================================
+void CDockManager::loadPerspectives(QSettings& Settings)
+{
+	d->Perspectives = CDockPersistenceJob::readPerspectives(Settings);
+	d->PerspectiveCache.clear();
 }
 
 
@@ -926,6 +1220,7 @@ CDockAreaWidget* CDockManager::setCentralWidget(CDockWidget* widget)
 	if (!widget)
 	{
 		d->CentralWidget = nullptr;
+		d->invalidatePerspectiveCache();
 		return nullptr;
 	}
 
@@ -951,6 +1246,7 @@ CDockAreaWidget* CDockManager::setCentralWidget(CDockWidget* widget)
 	widget->setFeature(CDockWidget::DockWidgetMovable, false);
 	widget->setFeature(CDockWidget::DockWidgetFloatable, false);
 	d->CentralWidget = widget;
+	d->invalidatePerspectiveCache();
 	CDockAreaWidget* CentralArea = addDockWidget(CenterDockWidgetArea, widget);
 	CentralArea->setDockAreaFlag(CDockAreaWidget::eDockAreaFlag::HideSingleWidgetTitleBar, true);
 	return CentralArea;
@@ -1042,6 +1338,34 @@ bool CDockManager::testConfigFlag(eConfigFlag Flag)
 }
 
 
+//===========================================================================
+void CDockManager::setContentSuspendDelay(int Milliseconds)
+{
+	StaticContentSuspendDelay = qMax(0, Milliseconds);
+}
+
+
+//===========================================================================
+int CDockManager::contentSuspendDelay()
+{
+	return StaticContentSuspendDelay;
+}
+
+
+//===========================================================================
+DockMetricsSnapshot CDockManager::metrics()
+{
+	return CDockMetrics::snapshot();
+}
+
+
+//===========================================================================
+void CDockManager::resetMetrics()
+{
+	CDockMetrics::reset();
+}
+
+
 //===========================================================================
 CIconProvider& CDockManager::iconProvider()
 {
@@ -0,0 +1,152 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockMetrics.cpp
+/// \date   16.10.2026
+/// \brief  Implementation of CDockMetrics
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockMetrics.h"
+
+#include <atomic>
+
+#include <QElapsedTimer>
+
+namespace ads
+{
+namespace
+{
+std::atomic<quint64> MetricCounts[DockMetricCount];
+std::atomic<qint64> MetricNanoseconds[DockMetricCount];
+
+const char* const MetricNames[DockMetricCount] =
+{
+	"style_sheet_sets",
+	"style_repolishes",
+	"splitter_insertions",
+	"splitter_handle_updates",
+	"floating_widgets_created",
+	"floating_widgets_deleted",
+	"relayouts",
+	"deferred_deletes",
+	"overlay_repaints"
+};
+} // namespace
+
+
+//============================================================================
+QVariantMap DockMetricsSnapshot::toVariantMap() const
+{
+	QVariantMap Map;
+	for (int i = 0; i < DockMetricCount; ++i)
+	{
+		auto Name = CDockMetrics::name(static_cast<eDockMetric>(i));
+		Map[Name] = Counts[i];
+		if (Nanoseconds[i])
+		{
+			Map[Name + "_ns"] = Nanoseconds[i];
+		}
+	}
+	return Map;
+}
+
+
+//============================================================================
+DockMetricsSnapshot DockMetricsSnapshot::operator-(
+	const DockMetricsSnapshot& Other) const
+{
+	DockMetricsSnapshot Result;
+	for (int i = 0; i < DockMetricCount; ++i)
+	{
+		Result.Counts[i] = Counts[i] - Other.Counts[i];
+		Result.Nanoseconds[i] = Nanoseconds[i] - Other.Nanoseconds[i];
+	}
+	return Result;
+}
+
+
+//============================================================================
+void CDockMetrics::increment(eDockMetric Metric, quint64 Count)
+{
+	MetricCounts[Metric].fetch_add(Count, std::memory_order_relaxed);
+}
+
+
+//============================================================================
+void CDockMetrics::addNsecs(eDockMetric Metric, qint64 Nanoseconds)
+{
+	MetricNanoseconds[Metric].fetch_add(Nanoseconds, std::memory_order_relaxed);
+}
+
+
+//============================================================================
+DockMetricsSnapshot CDockMetrics::snapshot()
+{
+	DockMetricsSnapshot Snapshot;
+	for (int i = 0; i < DockMetricCount; ++i)
+	{
+		Snapshot.Counts[i] = MetricCounts[i].load(std::memory_order_relaxed);
+		Snapshot.Nanoseconds[i] = MetricNanoseconds[i].load(std::memory_order_relaxed);
+	}
+	return Snapshot;
+}
+
+
+//============================================================================
+void CDockMetrics::reset()
+{
+	for (int i = 0; i < DockMetricCount; ++i)
+	{
+		MetricCounts[i].store(0, std::memory_order_relaxed);
+		MetricNanoseconds[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+//============================================================================
+QString CDockMetrics::name(eDockMetric Metric)
+{
+	if (Metric < 0 || Metric >= DockMetricCount)
+	{
+		return QString();
+	}
+	return QString::fromLatin1(MetricNames[Metric]);
+}
+
+
+//============================================================================
+qint64 CDockMetrics::now()
+{
+	static const QElapsedTimer Clock = []()
+	{
+		QElapsedTimer Timer;
+		Timer.start();
+		return Timer;
+	}();
+	return Clock.nsecsElapsed();
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockMetrics.cpp
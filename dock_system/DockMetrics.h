@@ -0,0 +1,183 @@
+#ifndef DockMetricsH
+#define DockMetricsH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockMetrics.h
+/// \date   16.10.2026
+/// \brief  Declaration of CDockMetrics and DockMetricsSnapshot
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "ads_globals.h"
+
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+namespace ads
+{
+/**
+ * The expensive side effects of layout operations that are counted
+ */
+enum eDockMetric
+{
+	StyleSheetSets,///< setStyleSheet() calls of the library
+	StyleRepolishes,///< internal::repolishStyle() runs
+	SplitterInsertions,///< widgets inserted into dock splitters
+	SplitterHandleUpdates,///< updateSplitterHandles() runs
+	FloatingWidgetsCreated,///< created floating dock containers
+	FloatingWidgetsDeleted,///< destroyed floating dock containers
+	Relayouts,///< deferred relayout runs of dock containers
+	DeferredDeletes,///< objects deleted with deleteLater()
+	OverlayRepaints,///< paint events of the drop overlays
+	DockMetricCount
+};
+
+
+/**
+ * Copy of all metric values at a certain point in time.
+ * The counters and durations are accumulated since the start of the
+ * application or since the last CDockManager::resetMetrics() call.
+ * Subtracting two snapshots gives the cost of the operation in between:
+ * \code
+ * auto Before = CDockManager::metrics();
+ * DockContainer->dropFloatingWidget(FloatingWidget, Pos);
+ * auto Cost = CDockManager::metrics() - Before;
+ * qDebug() << Cost.count(StyleRepolishes) << "repolishes";
+ * \endcode
+ */
+struct ADS_EXPORT DockMetricsSnapshot
+{
+	quint64 Counts[DockMetricCount] = {};
+	qint64 Nanoseconds[DockMetricCount] = {};
+
+	/**
+	 * Returns the number of occurrences of the given metric
+	 */
+	quint64 count(eDockMetric Metric) const {return Counts[Metric];}
+
+	/**
+	 * Returns the accumulated duration of the given metric in nanoseconds.
+	 * Only the metrics that are measured with CDockMetricScope have a
+	 * duration - for all other metrics this is 0.
+	 */
+	qint64 nsecs(eDockMetric Metric) const {return Nanoseconds[Metric];}
+
+	/**
+	 * Returns the values as a map for telemetry. Each metric is stored
+	 * with its name and, if it has a duration, with its name and the
+	 * suffix "_ns".
+	 */
+	QVariantMap toVariantMap() const;
+
+	/**
+	 * Returns the difference of this snapshot and the given snapshot
+	 */
+	DockMetricsSnapshot operator-(const DockMetricsSnapshot& Other) const;
+};
+
+
+/**
+ * Cheap always on metrics of the docking system.
+ * All values are relaxed atomics that are global for the process - so
+ * they can be updated from any thread without locking.
+ * Use CDockManager::metrics() and CDockManager::resetMetrics() to read
+ * and reset the values.
+ */
+class ADS_EXPORT CDockMetrics
+{
+public:
+	/**
+	 * Increments the counter of the given metric
+	 */
+	static void increment(eDockMetric Metric, quint64 Count = 1);
+
+	/**
+	 * Adds the given duration to the given metric
+	 */
+	static void addNsecs(eDockMetric Metric, qint64 Nanoseconds);
+
+	/**
+	 * Returns a snapshot of all metrics
+	 */
+	static DockMetricsSnapshot snapshot();
+
+	/**
+	 * Resets all metrics to 0
+	 */
+	static void reset();
+
+	/**
+	 * Returns the telemetry name of the given metric
+	 */
+	static QString name(eDockMetric Metric);
+
+	/**
+	 * Returns the monotonic clock used for the durations in nanoseconds
+	 */
+	static qint64 now();
+};
+
+
+/**
+ * Increments the given metric and adds the lifetime of the scope to its
+ * accumulated duration
+ */
+class CDockMetricScope
+{
+public:
+	explicit CDockMetricScope(eDockMetric Metric)
+		: Metric(Metric),
+		  Begin(CDockMetrics::now())
+	{
+		CDockMetrics::increment(Metric);
+	}
+
+	~CDockMetricScope()
+	{
+		CDockMetrics::addNsecs(Metric, CDockMetrics::now() - Begin);
+	}
+
+private:
+	Q_DISABLE_COPY(CDockMetricScope)
+	eDockMetric Metric;
+	qint64 Begin;
+};
+
+
+namespace internal
+{
+/**
+ * Counts the deferred deletion and calls Object->deleteLater()
+ */
+inline void deleteLater(QObject* Object)
+{
+	CDockMetrics::increment(DeferredDeletes);
+	Object->deleteLater();
+}
+} // namespace internal
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockMetricsH
@@ -34,16 +34,101 @@
 #include <QtGlobal>
 #include <QDebug>
 #include <QMap>
+#include <QHash>
 #include <QWindow>
+#include <QCoreApplication>
 
 #include "DockAreaWidget.h"
 #include "DockAreaTitleBar.h"
+#include "DockManager.h"
+#include "DockTrace.h"
+#include "DockMetrics.h"
 
 #include <iostream>
+#include <algorithm>
 
 namespace ads
 {
 
+/**
+ * Key of a rendered drop indicator pixmap in the drop indicator cache
+ */
+struct DropIndicatorKey
+{
+	int Mode;
+	int Area;
+	int Size;///< logical size, depends on the font metrics on some systems
+	qreal DevicePixelRatio;
+	QRgb Colors[5];///< icon colors in CDockOverlayCross::eIconColor order
+
+	bool operator==(const DropIndicatorKey& Other) const
+	{
+		return Mode == Other.Mode && Area == Other.Area && Size == Other.Size
+			&& qFuzzyCompare(DevicePixelRatio, Other.DevicePixelRatio)
+			&& std::equal(Colors, Colors + 5, Other.Colors);
+	}
+};
+
+
+//============================================================================
+static uint qHash(const DropIndicatorKey& Key, uint Seed = 0)
+{
+	uint Hash = ::qHash(Key.Mode, Seed) ^ ::qHash(Key.Area, Seed << 1)
+		^ ::qHash(Key.Size, Seed << 2) ^ ::qHash(qRound(Key.DevicePixelRatio * 100), Seed << 3);
+	for (auto Color : Key.Colors)
+	{
+		Hash = (Hash * 31) ^ ::qHash(Color, Seed);
+	}
+	return Hash;
+}
+
+
+/**
+ * Process wide cache of rendered drop indicator pixmaps. All overlays of all
+ * dock managers share the pixmaps, so switching between screens with
+ * different device pixel ratios renders each indicator only once.
+ * The cache is only accessed from the GUI thread.
+ */
+static QHash<DropIndicatorKey, QPixmap>& dropIndicatorPixmaps()
+{
+	static QHash<DropIndicatorKey, QPixmap> Cache;
+	return Cache;
+}
+
+static bool DropIndicatorCleanupRegistered = false;
+
+/**
+ * Post routine of the application. QPixmaps must not be destroyed after the
+ * QGuiApplication, so the pixmaps can not be left to the static destructor.
+ */
+static void clearDropIndicatorCache()
+{
+	dropIndicatorPixmaps().clear();
+	DropIndicatorCleanupRegistered = false;
+}
+
+/**
+ * Returns the drop indicator cache and ensures that it is cleared when the
+ * application is destroyed
+ */
+static QHash<DropIndicatorKey, QPixmap>& dropIndicatorCache()
+{
+	if (!DropIndicatorCleanupRegistered)
+	{
+		qAddPostRoutine(clearDropIndicatorCache);
+		DropIndicatorCleanupRegistered = true;
+	}
+	return dropIndicatorPixmaps();
+}
+
+/**
+ * The number of keys is small in practice (2 modes x 5 areas per screen
+ * and color set). The limit only protects against unbounded growth if an
+ * application keeps changing the icon colors.
+ */
+static const int MaxDropIndicatorCacheSize = 256;
+
+
 /**
  * Private data class of CDockOverlay
  */
@@ -57,11 +142,36 @@ struct DockOverlayPrivate
 	bool DropPreviewEnabled = true;
 	CDockOverlay::eMode Mode = CDockOverlay::ModeDockAreaOverlay;
 	QRect DropAreaRect;
+	bool SingleWindow = false;///< indicators are painted by the overlay itself
 
 	/**
 	 * Private data constructor
 	 */
 	DockOverlayPrivate(CDockOverlay* _public) : _this(_public) {}
+
+	/**
+	 * Returns the drop preview rectangle for the given area or a null
+	 * rectangle, if the area is invalid
+	 */
+	QRect previewRect(DockWidgetArea Area) const;
+
+	/**
+	 * Returns the logical size of a drop indicator icon
+	 */
+	int indicatorSize() const;
+
+	/**
+	 * Computes the geometry of the indicator for the given area in overlay
+	 * coordinates. The result matches the position the grid layout of the
+	 * overlay cross would give the indicator label.
+	 */
+	QRect indicatorRect(DockWidgetArea Area) const;
+
+	/**
+	 * Returns the allowed indicator area that contains the given position
+	 * in overlay coordinates
+	 */
+	DockWidgetArea indicatorAt(const QPoint& Pos) const;
 };
 
 /**
@@ -137,7 +247,7 @@ struct DockOverlayCrossPrivate
      * Helper function that returns the drop indicator width depending on the
      * operating system
      */
-    qreal dropIndicatiorWidth(QLabel* l) const
+    qreal dropIndicatiorWidth(const QWidget* l) const
     {
     #ifdef Q_OS_LINUX
         Q_UNUSED(l)
@@ -177,17 +287,59 @@ struct DockOverlayCrossPrivate
 	}
 
 	//============================================================================
+	/**
+	 * Returns the drop indicator pixmap from the process wide cache and
+	 * renders it only, if no pixmap with the same mode, area, size, device
+	 * pixel ratio and colors exists yet
+	 */
 	QPixmap createHighDpiDropIndicatorPixmap(const QSizeF& size, DockWidgetArea DockWidgetArea,
 		CDockOverlay::eMode Mode)
 	{
-		QColor borderColor = iconColor(CDockOverlayCross::FrameColor);
-		QColor backgroundColor = iconColor(CDockOverlayCross::WindowBackgroundColor);
-
 #if QT_VERSION >= 0x050600
 		double DevicePixelRatio = _this->window()->devicePixelRatioF();
 #else
         double DevicePixelRatio = _this->window()->devicePixelRatio();
 #endif
+		return cachedDropIndicatorPixmap(size, DockWidgetArea, Mode, DevicePixelRatio);
+	}
+
+	//============================================================================
+	QPixmap cachedDropIndicatorPixmap(const QSizeF& size, DockWidgetArea DockWidgetArea,
+		CDockOverlay::eMode Mode, double DevicePixelRatio)
+	{
+		DropIndicatorKey Key;
+		Key.Mode = Mode;
+		Key.Area = DockWidgetArea;
+		Key.Size = qRound(size.width());
+		Key.DevicePixelRatio = DevicePixelRatio;
+		for (int i = 0; i < 5; ++i)
+		{
+			Key.Colors[i] = iconColor(static_cast<CDockOverlayCross::eIconColor>(i)).rgba();
+		}
+
+		auto& Cache = dropIndicatorCache();
+		auto it = Cache.constFind(Key);
+		if (it != Cache.constEnd())
+		{
+			return it.value();
+		}
+
+		if (Cache.size() >= MaxDropIndicatorCacheSize)
+		{
+			Cache.clear();
+		}
+		QPixmap pm = renderDropIndicatorPixmap(size, DockWidgetArea, Mode, DevicePixelRatio);
+		Cache.insert(Key, pm);
+		return pm;
+	}
+
+	//============================================================================
+	QPixmap renderDropIndicatorPixmap(const QSizeF& size, DockWidgetArea DockWidgetArea,
+		CDockOverlay::eMode Mode, double DevicePixelRatio)
+	{
+		QColor borderColor = iconColor(CDockOverlayCross::FrameColor);
+		QColor backgroundColor = iconColor(CDockOverlayCross::WindowBackgroundColor);
+
 		QSizeF PixmapSize = size * DevicePixelRatio;
 		QPixmap pm(PixmapSize.toSize());
 		pm.fill(QColor(0, 0, 0, 0));
@@ -332,6 +484,7 @@ CDockOverlay::CDockOverlay(QWidget* parent, eMode Mode) :
 	d(new DockOverlayPrivate(this))
 {
 	d->Mode = Mode;
+	d->SingleWindow = CDockManager::testConfigFlag(CDockManager::SingleWindowDropOverlay);
 	d->Cross = new CDockOverlayCross(this);
 #ifdef Q_OS_LINUX
 	setWindowFlags(Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::X11BypassWindowManagerHint);
@@ -361,7 +514,14 @@ void CDockOverlay::setAllowedAreas(DockWidgetAreas areas)
 	if (areas == d->AllowedAreas)
 		return;
 	d->AllowedAreas = areas;
-	d->Cross->reset();
+	if (d->SingleWindow)
+	{
+		update();
+	}
+	else
+	{
+		d->Cross->reset();
+	}
 }
 
 
@@ -375,7 +535,9 @@ DockWidgetAreas CDockOverlay::allowedAreas() const
 //============================================================================
 DockWidgetArea CDockOverlay::dropAreaUnderCursor() const
 {
-	DockWidgetArea Result = d->Cross->cursorLocation();
+	DockWidgetArea Result = d->SingleWindow
+		? d->indicatorAt(mapFromGlobal(QCursor::pos()))
+		: d->Cross->cursorLocation();
 	if (Result != InvalidDockWidgetArea)
 	{
 		return Result;
@@ -415,13 +577,17 @@ DockWidgetArea CDockOverlay::visibleDropAreaUnderCursor() const
 //============================================================================
 DockWidgetArea CDockOverlay::showOverlay(QWidget* target)
 {
+	ADS_TRACE_SCOPE("CDockOverlay::showOverlay");
 	if (d->TargetWidget == target)
 	{
 		// Hint: We could update geometry of overlay here.
 		DockWidgetArea da = dropAreaUnderCursor();
 		if (da != d->LastLocation)
 		{
-			repaint();
+			// The preview rect is updated immediately because a drop may be
+			// evaluated before the scheduled repaint happens
+			d->DropAreaRect = d->DropPreviewEnabled ? d->previewRect(da) : QRect();
+			update();
 			d->LastLocation = da;
 		}
 		return da;
@@ -431,8 +597,17 @@ DockWidgetArea CDockOverlay::showOverlay(QWidget* target)
 	d->LastLocation = InvalidDockWidgetArea;
 
 	// Move it over the target.
-	resize(target->size());
 	QPoint TopLeft = target->mapToGlobal(target->rect().topLeft());
+	if (d->SingleWindow)
+	{
+		// One geometry change of one window - the indicators are painted
+		setGeometry(QRect(TopLeft, target->size()));
+		show();
+		update();
+		return dropAreaUnderCursor();
+	}
+
+	resize(target->size());
 	move(TopLeft);
 	show();
 	d->Cross->updatePosition();
@@ -469,41 +644,34 @@ bool CDockOverlay::dropPreviewEnabled() const
 //============================================================================
 void CDockOverlay::paintEvent(QPaintEvent* event)
 {
+	ADS_TRACE_SCOPE("CDockOverlay::paintEvent");
+	CDockMetricScope Metric(OverlayRepaints);
 	Q_UNUSED(event);
 	// Draw rect based on location
-	if (!d->DropPreviewEnabled)
+	QRect r = d->DropPreviewEnabled ? d->previewRect(dropAreaUnderCursor()) : QRect();
+	d->DropAreaRect = r;
+	if (!r.isNull())
 	{
-		d->DropAreaRect = QRect();
-		return;
+		QPainter painter(this);
+		QColor Color = palette().color(QPalette::Active, QPalette::Highlight);
+		QPen Pen = painter.pen();
+		Pen.setColor(Color.darker(120));
+		Pen.setStyle(Qt::SolidLine);
+		Pen.setWidth(1);
+		Pen.setCosmetic(true);
+		painter.setPen(Pen);
+		Color = Color.lighter(130);
+		Color.setAlpha(64);
+		painter.setBrush(Color);
+		painter.drawRect(r.adjusted(0, 0, -1, -1));
 	}
 
-	QRect r = rect();
-	const DockWidgetArea da = dropAreaUnderCursor();
-	double Factor = (CDockOverlay::ModeContainerOverlay == d->Mode) ?
-		3 : 2;
-
-	switch (da)
+	// The indicators are painted last to stay on top of the preview like
+	// the indicator widgets of the overlay cross
+	if (d->SingleWindow)
 	{
-    case TopDockWidgetArea: r.setHeight(r.height() / Factor); break;
-	case RightDockWidgetArea: r.setX(r.width() * (1 - 1 / Factor)); break;
-	case BottomDockWidgetArea: r.setY(r.height() * (1 - 1 / Factor)); break;
-	case LeftDockWidgetArea: r.setWidth(r.width() / Factor); break;
-	case CenterDockWidgetArea: r = rect();break;
-	default: return;
-	}
-	QPainter painter(this);
-    QColor Color = palette().color(QPalette::Active, QPalette::Highlight);
-    QPen Pen = painter.pen();
-    Pen.setColor(Color.darker(120));
-    Pen.setStyle(Qt::SolidLine);
-    Pen.setWidth(1);
-    Pen.setCosmetic(true);
-    painter.setPen(Pen);
-    Color = Color.lighter(130);
-    Color.setAlpha(64);
-    painter.setBrush(Color);
-	painter.drawRect(r.adjusted(0, 0, -1, -1));
-	d->DropAreaRect = r;
+		paintDropIndicators();
+	}
 }
 
 
@@ -514,10 +682,38 @@ QRect CDockOverlay::dropOverlayRect() const
 }
 
 
+//============================================================================
+void CDockOverlay::paintDropIndicators()
+{
+#if QT_VERSION >= 0x050600
+	double DevicePixelRatio = devicePixelRatioF();
+#else
+	double DevicePixelRatio = devicePixelRatio();
+#endif
+	static const DockWidgetArea Areas[] = {TopDockWidgetArea, RightDockWidgetArea,
+		BottomDockWidgetArea, LeftDockWidgetArea, CenterDockWidgetArea};
+	QPainter Painter(this);
+	for (auto Area : Areas)
+	{
+		if (!d->AllowedAreas.testFlag(Area))
+		{
+			continue;
+		}
+
+		QRect Rect = d->indicatorRect(Area);
+		Painter.drawPixmap(Rect.topLeft(),
+			d->Cross->dropIndicatorPixmap(Area, d->Mode, Rect.width(), DevicePixelRatio));
+	}
+}
+
+
 //============================================================================
 void CDockOverlay::showEvent(QShowEvent* e)
 {
-	d->Cross->show();
+	if (!d->SingleWindow)
+	{
+		d->Cross->show();
+	}
 	QFrame::showEvent(e);
 }
 
@@ -525,7 +721,10 @@ void CDockOverlay::showEvent(QShowEvent* e)
 //============================================================================
 void CDockOverlay::hideEvent(QHideEvent* e)
 {
-	d->Cross->hide();
+	if (!d->SingleWindow)
+	{
+		d->Cross->hide();
+	}
 	QFrame::hideEvent(e);
 }
 
@@ -536,7 +735,16 @@ bool CDockOverlay::event(QEvent *e)
 	bool Result = Super::event(e);
 	if (e->type() == QEvent::Polish)
 	{
-		d->Cross->setupOverlayCross(d->Mode);
+		if (d->SingleWindow)
+		{
+			// The cross window is never shown. It is only polished to pick up
+			// the icon colors from the style sheet.
+			d->Cross->ensurePolished();
+		}
+		else
+		{
+			d->Cross->setupOverlayCross(d->Mode);
+		}
 	}
 	return Result;
 }
@@ -556,6 +764,98 @@ static int areaAlignment(const DockWidgetArea area)
 	}
 }
 
+//============================================================================
+// DockOverlayPrivate
+//============================================================================
+QRect DockOverlayPrivate::previewRect(DockWidgetArea Area) const
+{
+	QRect r = _this->rect();
+	double Factor = (CDockOverlay::ModeContainerOverlay == Mode) ?
+		3 : 2;
+
+	switch (Area)
+	{
+    case TopDockWidgetArea: r.setHeight(r.height() / Factor); break;
+	case RightDockWidgetArea: r.setX(r.width() * (1 - 1 / Factor)); break;
+	case BottomDockWidgetArea: r.setY(r.height() * (1 - 1 / Factor)); break;
+	case LeftDockWidgetArea: r.setWidth(r.width() / Factor); break;
+	case CenterDockWidgetArea: break;
+	default: return QRect();
+	}
+	return r;
+}
+
+
+//============================================================================
+int DockOverlayPrivate::indicatorSize() const
+{
+#ifdef Q_OS_LINUX
+	return 40;
+#else
+	return qRound(static_cast<qreal>(_this->fontMetrics().height()) * 3.f);
+#endif
+}
+
+
+//============================================================================
+QRect DockOverlayPrivate::indicatorRect(DockWidgetArea Area) const
+{
+	const int Size = indicatorSize();
+	const QRect OverlayRect = _this->rect();
+	QRect Rect(0, 0, Size, Size);
+	Rect.moveCenter(OverlayRect.center());
+	if (CDockOverlay::ModeDockAreaOverlay == Mode)
+	{
+		// The five indicators form a centered cross without spacing
+		switch (Area)
+		{
+			case TopDockWidgetArea: return Rect.translated(0, -Size);
+			case RightDockWidgetArea: return Rect.translated(Size, 0);
+			case BottomDockWidgetArea: return Rect.translated(0, Size);
+			case LeftDockWidgetArea: return Rect.translated(-Size, 0);
+			case CenterDockWidgetArea: return Rect;
+			default: return QRect();
+		}
+	}
+	else
+	{
+		// The outer indicators are placed at the border with the
+		// contents margin of the container cross layout
+		const int Margin = 4;
+		switch (Area)
+		{
+			case TopDockWidgetArea: Rect.moveTop(OverlayRect.top() + Margin); return Rect;
+			case RightDockWidgetArea: Rect.moveRight(OverlayRect.right() - Margin); return Rect;
+			case BottomDockWidgetArea: Rect.moveBottom(OverlayRect.bottom() - Margin); return Rect;
+			case LeftDockWidgetArea: Rect.moveLeft(OverlayRect.left() + Margin); return Rect;
+			case CenterDockWidgetArea: return Rect;
+			default: return QRect();
+		}
+	}
+}
+
+
+//============================================================================
+DockWidgetArea DockOverlayPrivate::indicatorAt(const QPoint& Pos) const
+{
+	if (!_this->isVisible())
+	{
+		return InvalidDockWidgetArea;
+	}
+
+	static const DockWidgetArea Areas[] = {TopDockWidgetArea, RightDockWidgetArea,
+		BottomDockWidgetArea, LeftDockWidgetArea, CenterDockWidgetArea};
+	for (auto Area : Areas)
+	{
+		if (AllowedAreas.testFlag(Area) && indicatorRect(Area).contains(Pos))
+		{
+			return Area;
+		}
+	}
+	return InvalidDockWidgetArea;
+}
+
+
 //============================================================================
 // DockOverlayCrossPrivate
 //============================================================================
@@ -618,6 +918,25 @@ CDockOverlayCross::~CDockOverlayCross()
 //============================================================================
 void CDockOverlayCross::setupOverlayCross(CDockOverlay::eMode Mode)
 {
+	// The indicator widgets only depend on the mode. If they already exist,
+	// it is sufficient to fetch the pixmaps for the current colors and device
+	// pixel ratio from the cache instead of recreating all label widgets.
+	if (d->Mode == Mode && d->DropIndicatorWidgets.count() == 5)
+	{
+		for (auto Widget : d->DropIndicatorWidgets)
+		{
+			d->updateDropIndicatorIcon(Widget);
+		}
+#if QT_VERSION >= 0x050600
+		d->LastDevicePixelRatio = devicePixelRatioF();
+#else
+		d->LastDevicePixelRatio = devicePixelRatio();
+#endif
+		d->UpdateRequired = false;
+		reset();
+		return;
+	}
+
 	d->Mode = Mode;
 
 	QHash<DockWidgetArea, QWidget*> areaWidgets;
@@ -671,6 +990,14 @@ QColor CDockOverlayCross::iconColor(eIconColor ColorIndex) const
 }
 
 
+//============================================================================
+QPixmap CDockOverlayCross::dropIndicatorPixmap(DockWidgetArea Area,
+	CDockOverlay::eMode Mode, int Size, qreal DevicePixelRatio) const
+{
+	return d->cachedDropIndicatorPixmap(QSizeF(Size, Size), Area, Mode, DevicePixelRatio);
+}
+
+
 //============================================================================
 void CDockOverlayCross::setAreaWidgets(const QHash<DockWidgetArea, QWidget*>& widgets)
 {
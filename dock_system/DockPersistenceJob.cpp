@@ -0,0 +1,220 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockPersistenceJob.cpp
+/// \date   16.10.2026
+/// \brief  Implementation of CDockPersistenceJob
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockPersistenceJob.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSettings>
+
+#include <memory>
+
+namespace ads
+{
+/**
+ * Event that transfers a finished job from the worker thread to its
+ * receiver. The event owns the job.
+ */
+class CJobFinishedEvent : public QEvent
+{
+public:
+	std::unique_ptr<CDockPersistenceJob> Job;
+
+	static QEvent::Type eventType()
+	{
+		static const QEvent::Type Type = static_cast<QEvent::Type>(
+			QEvent::registerEventType());
+		return Type;
+	}
+
+	CJobFinishedEvent(CDockPersistenceJob* Job)
+		: QEvent(eventType()),
+		  Job(Job)
+	{}
+};
+
+
+//============================================================================
+CDockPersistenceJob::CDockPersistenceJob(eOperation Operation, const QString& FileName)
+	: Operation(Operation),
+	  FileName(FileName)
+{
+	setAutoDelete(false);
+}
+
+
+//============================================================================
+bool CDockPersistenceJob::writeFile(const QByteArray& Data)
+{
+	// QSaveFile writes into a temporary file and renames it on commit, so a
+	// crash during writing never leaves a truncated file behind
+	QSaveFile File(FileName);
+	if (!File.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+
+	if (File.write(Data) != Data.size())
+	{
+		File.cancelWriting();
+		return false;
+	}
+
+	return File.commit();
+}
+
+
+//============================================================================
+void CDockPersistenceJob::writePerspectives(QSettings& Settings,
+	const QMap<QString, QByteArray>& Perspectives)
+{
+	Settings.beginWriteArray("Perspectives", Perspectives.size());
+	int i = 0;
+	for (auto it = Perspectives.constBegin(); it != Perspectives.constEnd(); ++it)
+	{
+		Settings.setArrayIndex(i);
+		Settings.setValue("Name", it.key());
+		Settings.setValue("State", it.value());
+		++i;
+	}
+	Settings.endArray();
+}
+
+
+//============================================================================
+QMap<QString, QByteArray> CDockPersistenceJob::readPerspectives(QSettings& Settings)
+{
+	QMap<QString, QByteArray> Perspectives;
+	int Size = Settings.beginReadArray("Perspectives");
+	for (int i = 0; i < Size; ++i)
+	{
+		Settings.setArrayIndex(i);
+		QString Name = Settings.value("Name").toString();
+		QByteArray Data = Settings.value("State").toByteArray();
+		if (Name.isEmpty() || Data.isEmpty())
+		{
+			continue;
+		}
+
+		Perspectives.insert(Name, Data);
+	}
+	Settings.endArray();
+	return Perspectives;
+}
+
+
+//============================================================================
+bool CDockPersistenceJob::savePerspectives()
+{
+	// QSettings replaces the file only after all data has been written.
+	// Entries of a previous, larger perspective list are removed.
+	QSettings Settings(FileName, QSettings::IniFormat);
+	Settings.remove("Perspectives");
+	writePerspectives(Settings, Perspectives);
+	Settings.sync();
+	return Settings.status() == QSettings::NoError;
+}
+
+
+//============================================================================
+bool CDockPersistenceJob::loadPerspectives()
+{
+	// QSettings treats a missing file like an empty one
+	if (!QFileInfo::exists(FileName))
+	{
+		return false;
+	}
+
+	QSettings Settings(FileName, QSettings::IniFormat);
+	Perspectives = readPerspectives(Settings);
+	if (Settings.status() != QSettings::NoError)
+	{
+		Perspectives.clear();
+		return false;
+	}
+
+	// Perspectives that can not be parsed are still loaded - they are
+	// rejected when they are opened, like in the synchronous code
+	for (auto it = Perspectives.constBegin(); it != Perspectives.constEnd(); ++it)
+	{
+		DockLayoutState Layout;
+		if (CDockStateSerializer::readState(it.value(), Layout))
+		{
+			ParsedPerspectives.insert(it.key(), Layout);
+		}
+	}
+	return true;
+}
+
+
+//============================================================================
+void CDockPersistenceJob::run()
+{
+	switch (Operation)
+	{
+	case SaveState:
+		Ok = writeFile(CDockStateSerializer::writeState(Layout, Binary,
+			Compress, AutoFormatting));
+		break;
+
+	case SavePerspectives:
+		Ok = savePerspectives();
+		break;
+
+	case LoadPerspectives:
+		Ok = loadPerspectives();
+		break;
+	}
+
+	// The receiver may delete the job as soon as the event is posted
+	QCoreApplication::postEvent(Receiver, new CJobFinishedEvent(this));
+}
+
+
+//============================================================================
+bool CDockPersistenceJobReceiver::event(QEvent* Event)
+{
+	if (Event->type() != CJobFinishedEvent::eventType())
+	{
+		return QObject::event(Event);
+	}
+
+	auto Job = static_cast<CJobFinishedEvent*>(Event)->Job.get();
+	if (Job->Finished)
+	{
+		Job->Finished(Job);
+	}
+	return true;
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockPersistenceJob.cpp
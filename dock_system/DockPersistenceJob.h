@@ -0,0 +1,127 @@
+#ifndef DockPersistenceJobH
+#define DockPersistenceJobH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockPersistenceJob.h
+/// \date   16.10.2026
+/// \brief  Declaration of CDockPersistenceJob
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "ads_globals.h"
+#include "DockStateSerializer.h"
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QRunnable>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(QSettings)
+
+namespace ads
+{
+class CDockPersistenceJobReceiver;
+
+/**
+ * Background job for saving and loading dock states and perspectives.
+ * All inputs are snapshots taken on the GUI thread. The run() function
+ * only touches this snapshot data - it never accesses any widgets, so it
+ * can safely run on a worker thread. States are written via QSaveFile, so
+ * an existing file is only replaced if the complete data has been written.
+ * Perspective files are INI files with the layout of
+ * CDockManager::savePerspectives(), so the synchronous and asynchronous
+ * functions can read the files of each other.
+ * When run() is done, it posts the job to its Receiver and does not touch
+ * the job anymore. From then on the job is owned by the posted event.
+ */
+class CDockPersistenceJob : public QRunnable
+{
+public:
+	enum eOperation
+	{
+		SaveState,       ///< serializes Layout and writes it into FileName
+		SavePerspectives,///< writes Perspectives into the INI file FileName
+		LoadPerspectives ///< reads Perspectives from the INI file and parses them
+	};
+
+	eOperation Operation;
+	QString FileName;
+	DockLayoutState Layout;///< input of SaveState
+	bool Binary = false;///< SaveState writes binary instead of XML data
+	bool Compress = false;///< SaveState compresses the XML data
+	bool AutoFormatting = false;///< SaveState formats the XML data
+	QMap<QString, QByteArray> Perspectives;///< input of save, output of load
+	QHash<QString, DockLayoutState> ParsedPerspectives;///< output of load
+	bool Ok = false;///< true, if the job finished successfully
+	CDockPersistenceJobReceiver* Receiver = nullptr;///< GUI thread receiver
+	std::function<void(CDockPersistenceJob*)> Finished;///< called by Receiver
+
+	/**
+	 * Creates a job for the given operation and file
+	 */
+	CDockPersistenceJob(eOperation Operation, const QString& FileName);
+
+	/**
+	 * Executes the job
+	 */
+	virtual void run() override;
+
+	/**
+	 * Writes the given perspectives into the "Perspectives" array of the
+	 * given settings
+	 */
+	static void writePerspectives(QSettings& Settings,
+		const QMap<QString, QByteArray>& Perspectives);
+
+	/**
+	 * Reads the perspectives from the "Perspectives" array of the given
+	 * settings. Entries without name or state are skipped.
+	 */
+	static QMap<QString, QByteArray> readPerspectives(QSettings& Settings);
+
+private:
+	bool writeFile(const QByteArray& Data);
+	bool savePerspectives();
+	bool loadPerspectives();
+};
+
+
+/**
+ * Receives the finished persistence jobs on the GUI thread, calls their
+ * Finished function and deletes them. The receiver must outlive the thread
+ * pool that runs the jobs, so that a job can always post itself to it.
+ * Jobs that are still pending when the receiver is destroyed are deleted
+ * without calling Finished.
+ */
+class CDockPersistenceJobReceiver : public QObject
+{
+public:
+	virtual bool event(QEvent* Event) override;
+};
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockPersistenceJobH
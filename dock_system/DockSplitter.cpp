@@ -33,6 +33,7 @@
 #include <QChildEvent>
 
 #include "DockAreaWidget.h"
+#include "DockMetrics.h"
 
 namespace ads
 {
@@ -116,6 +117,23 @@ bool CDockSplitter::isResizingWithContainer() const
     return false;
 }
 
+
+//============================================================================
+void CDockSplitter::childEvent(QChildEvent* event)
+{
+	// The splitter handles are child widgets, too. A handle is added while
+	// it is still inside of its QWidget constructor, so qobject_cast can not
+	// identify it. Dock areas and splitters are always constructed before
+	// they are inserted, so only these children are counted.
+	QObject* Child = event->child();
+	if (event->added() && (qobject_cast<CDockAreaWidget*>(Child)
+	 || qobject_cast<QSplitter*>(Child)))
+	{
+		CDockMetrics::increment(SplitterInsertions);
+	}
+	QSplitter::childEvent(event);
+}
+
 } // namespace ads
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,787 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockStateSerializer.cpp
+/// \date   16.10.2026
+/// \brief  Implementation of CDockStateSerializer
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockStateSerializer.h"
+
+#include <QDataStream>
+#include <QHash>
+#include <QStringList>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+
+#include "DockingStateReader.h"
+
+#if QT_VERSION < 0x050900
+// Defined in DockContainerWidget.cpp
+QByteArray qByteArrayToHex(const QByteArray& src, char separator);
+#endif
+
+namespace ads
+{
+/**
+ * Magic number at the start of binary state data ("ADSB"). The first four
+ * bytes of qCompress() output are the uncompressed size and XML data starts
+ * with "<?xml", so the three formats can be told apart safely.
+ */
+static const quint32 BinaryStateMagic = 0x41445342;
+
+/**
+ * Version of the binary record layout
+ */
+enum eBinaryFormatVersion
+{
+	BinaryVersion1 = 1,
+	CurrentBinaryVersion = BinaryVersion1
+};
+
+/**
+ * Record tags
+ */
+enum eRecordTag
+{
+	ContainerTag = 'C',
+	SplitterTag = 'S',
+	AreaTag = 'A',
+	WidgetTag = 'W'
+};
+
+
+/**
+ * Helper for building the interned name table while writing
+ */
+struct NameTable
+{
+	QStringList Names;
+	QHash<QString, qint32> Indices;
+
+	qint32 intern(const QString& Name)
+	{
+		if (Name.isEmpty())
+		{
+			return -1;
+		}
+
+		auto it = Indices.constFind(Name);
+		if (it != Indices.constEnd())
+		{
+			return it.value();
+		}
+
+		qint32 Index = Names.count();
+		Names.append(Name);
+		Indices.insert(Name, Index);
+		return Index;
+	}
+};
+
+
+//============================================================================
+static void writeNode(QDataStream& s, const DockLayoutNode& Node, NameTable& Names)
+{
+	switch (Node.Type)
+	{
+	case DockLayoutNode::SplitterNode:
+		s << quint8(SplitterTag)
+		  << quint8(Node.Orientation)
+		  << quint32(Node.Count)
+		  << quint32(Node.Sizes.count());
+		for (auto Size : Node.Sizes)
+		{
+			s << qint32(Size);
+		}
+		break;
+
+	case DockLayoutNode::AreaNode:
+		s << quint8(AreaTag)
+		  << Names.intern(Node.Name)
+		  << qint32(Node.AllowedAreas)
+		  << qint32(Node.Flags)
+		  << quint32(Node.Count);
+		break;
+
+	case DockLayoutNode::WidgetNode:
+		s << quint8(WidgetTag)
+		  << Names.intern(Node.Name)
+		  << quint8(Node.Closed ? 1 : 0);
+		break;
+	}
+}
+
+
+//============================================================================
+static bool readName(QDataStream& s, const QStringList& Names, QString& Name)
+{
+	qint32 Index;
+	s >> Index;
+	if (Index < -1 || Index >= Names.count())
+	{
+		return false;
+	}
+
+	Name = (Index < 0) ? QString() : Names[Index];
+	return true;
+}
+
+
+//============================================================================
+static bool readNode(QDataStream& s, const QStringList& Names, DockLayoutNode& Node)
+{
+	quint8 Tag;
+	quint32 Count;
+	s >> Tag;
+	switch (Tag)
+	{
+	case SplitterTag:
+		{
+			quint8 Orientation;
+			quint32 SizeCount;
+			s >> Orientation >> Count >> SizeCount;
+			if (Orientation != Qt::Horizontal && Orientation != Qt::Vertical)
+			{
+				return false;
+			}
+
+			Node.Type = DockLayoutNode::SplitterNode;
+			Node.Orientation = static_cast<Qt::Orientation>(Orientation);
+			for (quint32 i = 0; i < SizeCount && s.status() == QDataStream::Ok; ++i)
+			{
+				qint32 Size;
+				s >> Size;
+				Node.Sizes.append(Size);
+			}
+		}
+		break;
+
+	case AreaTag:
+		{
+			qint32 AllowedAreas;
+			qint32 Flags;
+			Node.Type = DockLayoutNode::AreaNode;
+			if (!readName(s, Names, Node.Name))
+			{
+				return false;
+			}
+			s >> AllowedAreas >> Flags >> Count;
+			Node.AllowedAreas = AllowedAreas;
+			Node.Flags = Flags;
+		}
+		break;
+
+	case WidgetTag:
+		{
+			quint8 Closed;
+			Node.Type = DockLayoutNode::WidgetNode;
+			if (!readName(s, Names, Node.Name))
+			{
+				return false;
+			}
+			s >> Closed;
+			Node.Closed = Closed;
+			Count = 0;
+		}
+		break;
+
+	default:
+		return false;
+	}
+
+	Node.Count = static_cast<int>(Count);
+	return (s.status() == QDataStream::Ok) && (Node.Count >= 0);
+}
+
+
+//============================================================================
+/**
+ * Validates the subtree that starts at Index and moves Index behind it.
+ * This is the single structural check for the binary and the XML reader.
+ */
+static bool validateSubtree(const QVector<DockLayoutNode>& Nodes, int& Index)
+{
+	if (Index >= Nodes.count())
+	{
+		return false;
+	}
+
+	const auto& Node = Nodes[Index++];
+	switch (Node.Type)
+	{
+	case DockLayoutNode::SplitterNode:
+		// Each child subtree needs exactly one size
+		if (Node.Sizes.count() != Node.Count)
+		{
+			return false;
+		}
+		for (int i = 0; i < Node.Count; ++i)
+		{
+			if (!validateSubtree(Nodes, Index))
+			{
+				return false;
+			}
+		}
+		return true;
+
+	case DockLayoutNode::AreaNode:
+		for (int i = 0; i < Node.Count; ++i)
+		{
+			if (Index >= Nodes.count())
+			{
+				return false;
+			}
+			const auto& Widget = Nodes[Index++];
+			if (Widget.Type != DockLayoutNode::WidgetNode || Widget.Name.isEmpty())
+			{
+				return false;
+			}
+		}
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+
+//============================================================================
+static bool validateNodes(const QVector<DockLayoutNode>& Nodes)
+{
+	if (Nodes.isEmpty())
+	{
+		return true;
+	}
+
+	// The container requires a splitter as root of its layout
+	if (Nodes[0].Type != DockLayoutNode::SplitterNode)
+	{
+		return false;
+	}
+
+	int Index = 0;
+	return validateSubtree(Nodes, Index) && (Index == Nodes.count());
+}
+
+
+static bool readXmlChildNodes(CDockingStateReader& s, QVector<DockLayoutNode>& Nodes);
+
+
+//============================================================================
+static bool readXmlSplitter(CDockingStateReader& s, QVector<DockLayoutNode>& Nodes)
+{
+	bool Ok;
+	QString OrientationStr = s.attributes().value("Orientation").toString();
+
+	// Check if the orientation string is right
+	if (!OrientationStr.startsWith("|") && !OrientationStr.startsWith("-"))
+	{
+		return false;
+	}
+
+	// The "|" shall indicate a vertical splitter handle which in turn means
+	// a Horizontal orientation of the splitter layout.
+	bool HorizontalSplitter = OrientationStr.startsWith("|");
+	// In version 0 we had a small bug. The "|" indicated a vertical orientation,
+	// but this is wrong, because only the splitter handle is vertical, the
+	// layout of the splitter is a horizontal layout. We fix this here
+	if (s.fileVersion() == 0)
+	{
+		HorizontalSplitter = !HorizontalSplitter;
+	}
+
+	int WidgetCount = s.attributes().value("Count").toInt(&Ok);
+	if (!Ok)
+	{
+		return false;
+	}
+
+	// The splitter node is stored before its children, so we keep its index
+	// and update the child count when all children have been parsed
+	int NodeIndex = Nodes.count();
+	DockLayoutNode Node;
+	Node.Type = DockLayoutNode::SplitterNode;
+	Node.Orientation = HorizontalSplitter ? Qt::Horizontal : Qt::Vertical;
+	Nodes.append(Node);
+	int ChildCount = 0;
+	QList<int> Sizes;
+	while (s.readNextStartElement())
+	{
+		if (s.name() == "Splitter" || s.name() == "Area")
+		{
+			if (!readXmlChildNodes(s, Nodes))
+			{
+				return false;
+			}
+			ChildCount++;
+		}
+		else if (s.name() == "Sizes")
+		{
+			QString sSizes = s.readElementText().trimmed();
+			QTextStream TextStream(&sSizes);
+			while (!TextStream.atEnd())
+			{
+				int value;
+				TextStream >> value;
+				Sizes.append(value);
+			}
+		}
+		else
+		{
+			s.skipCurrentElement();
+		}
+	}
+
+	if (Sizes.count() != WidgetCount)
+	{
+		return false;
+	}
+
+	Nodes[NodeIndex].Count = ChildCount;
+	Nodes[NodeIndex].Sizes = Sizes;
+	return true;
+}
+
+
+//============================================================================
+static bool readXmlDockArea(CDockingStateReader& s, QVector<DockLayoutNode>& Nodes)
+{
+	bool Ok;
+	int NodeIndex = Nodes.count();
+	DockLayoutNode Node;
+	Node.Type = DockLayoutNode::AreaNode;
+	Node.Name = s.attributes().value("Current").toString();
+	const auto AllowedAreasAttribute = s.attributes().value("AllowedAreas");
+	if (!AllowedAreasAttribute.isEmpty())
+	{
+		Node.AllowedAreas = AllowedAreasAttribute.toInt(nullptr, 16);
+	}
+
+	const auto FlagsAttribute = s.attributes().value("Flags");
+	if (!FlagsAttribute.isEmpty())
+	{
+		Node.Flags = FlagsAttribute.toInt(nullptr, 16);
+	}
+	Nodes.append(Node);
+
+	int WidgetCount = 0;
+	while (s.readNextStartElement())
+	{
+		if (s.name() != "Widget")
+		{
+			s.skipCurrentElement();
+			continue;
+		}
+
+		DockLayoutNode WidgetNode;
+		WidgetNode.Type = DockLayoutNode::WidgetNode;
+		WidgetNode.Name = s.attributes().value("Name").toString();
+		if (WidgetNode.Name.isEmpty())
+		{
+			return false;
+		}
+
+		WidgetNode.Closed = s.attributes().value("Closed").toInt(&Ok);
+		if (!Ok)
+		{
+			return false;
+		}
+
+		s.skipCurrentElement();
+		Nodes.append(WidgetNode);
+		WidgetCount++;
+	}
+
+	Nodes[NodeIndex].Count = WidgetCount;
+	return true;
+}
+
+
+//============================================================================
+static bool readXmlChildNodes(CDockingStateReader& s, QVector<DockLayoutNode>& Nodes)
+{
+	if (s.name() == "Splitter")
+	{
+		return readXmlSplitter(s, Nodes);
+	}
+	else
+	{
+		return readXmlDockArea(s, Nodes);
+	}
+}
+
+
+//============================================================================
+static bool readXmlContainer(CDockingStateReader& s, DockLayoutContainer& Container)
+{
+	Container.Floating = s.attributes().value("Floating").toInt();
+	if (Container.Floating)
+	{
+		if (!s.readNextStartElement() || s.name() != "Geometry")
+		{
+			return false;
+		}
+
+		QByteArray GeometryString = s.readElementText(CDockingStateReader::ErrorOnUnexpectedElement).toLocal8Bit();
+		Container.Geometry = QByteArray::fromHex(GeometryString);
+		if (Container.Geometry.isEmpty())
+		{
+			return false;
+		}
+	}
+
+	// If there is more than one root node, the last one wins - this is the
+	// behaviour of the widget based restore code
+	while (s.readNextStartElement())
+	{
+		if (s.name() != "Splitter" && s.name() != "Area")
+		{
+			s.skipCurrentElement();
+			continue;
+		}
+
+		Container.Nodes.clear();
+		if (!readXmlChildNodes(s, Container.Nodes))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//============================================================================
+static void writeXmlSubtree(QXmlStreamWriter& s, const QVector<DockLayoutNode>& Nodes,
+	int& Index)
+{
+	const DockLayoutNode& Node = Nodes[Index++];
+	if (Node.Type == DockLayoutNode::SplitterNode)
+	{
+		s.writeStartElement("Splitter");
+		s.writeAttribute("Orientation", (Node.Orientation == Qt::Horizontal) ? "|" : "-");
+		s.writeAttribute("Count", QString::number(Node.Count));
+		for (int i = 0; i < Node.Count; ++i)
+		{
+			writeXmlSubtree(s, Nodes, Index);
+		}
+
+		s.writeStartElement("Sizes");
+		for (auto Size : Node.Sizes)
+		{
+			s.writeCharacters(QString::number(Size) + " ");
+		}
+		s.writeEndElement();
+		s.writeEndElement();
+		return;
+	}
+
+	s.writeStartElement("Area");
+	s.writeAttribute("Tabs", QString::number(Node.Count));
+	s.writeAttribute("Current", Node.Name);
+	if (Node.AllowedAreas >= 0)
+	{
+		s.writeAttribute("AllowedAreas", QString::number(Node.AllowedAreas, 16));
+	}
+
+	if (Node.Flags >= 0)
+	{
+		s.writeAttribute("Flags", QString::number(Node.Flags, 16));
+	}
+
+	for (int i = 0; i < Node.Count; ++i)
+	{
+		const DockLayoutNode& WidgetNode = Nodes[Index++];
+		s.writeStartElement("Widget");
+		s.writeAttribute("Name", WidgetNode.Name);
+		s.writeAttribute("Closed", QString::number(WidgetNode.Closed ? 1 : 0));
+		s.writeEndElement();
+	}
+	s.writeEndElement();
+}
+
+
+//============================================================================
+bool CDockStateSerializer::isBinaryState(const QByteArray& Data)
+{
+	if (Data.size() < int(sizeof(BinaryStateMagic)))
+	{
+		return false;
+	}
+
+	QDataStream s(Data);
+	quint32 Magic;
+	s >> Magic;
+	return Magic == BinaryStateMagic;
+}
+
+
+//============================================================================
+QByteArray CDockStateSerializer::writeBinary(const DockLayoutState& State)
+{
+	// The records are written first because the name table is built while
+	// writing them. The header and the name table are prepended afterwards.
+	NameTable Names;
+	QByteArray Records;
+	QDataStream r(&Records, QIODevice::WriteOnly);
+	r.setVersion(QDataStream::Qt_5_5);
+	qint32 CentralWidget = Names.intern(State.CentralWidget);
+	r << quint32(State.Containers.count());
+	for (const auto& Container : State.Containers)
+	{
+		r << quint8(ContainerTag)
+		  << quint8(Container.Floating ? 1 : 0)
+		  << Container.Geometry
+		  << quint32(Container.Nodes.count());
+		for (const auto& Node : Container.Nodes)
+		{
+			writeNode(r, Node, Names);
+		}
+	}
+
+	QByteArray Data;
+	Data.reserve(Records.size() + Names.Names.count() * 32 + 64);
+	QDataStream s(&Data, QIODevice::WriteOnly);
+	s.setVersion(QDataStream::Qt_5_5);
+	s << BinaryStateMagic
+	  << quint16(CurrentBinaryVersion)
+	  << qint32(State.Version)
+	  << qint32(State.UserVersion)
+	  << Names.Names
+	  << CentralWidget;
+	s.writeRawData(Records.constData(), Records.size());
+	return Data;
+}
+
+
+//============================================================================
+bool CDockStateSerializer::readBinary(const QByteArray& Data, DockLayoutState& State)
+{
+	QDataStream s(Data);
+	s.setVersion(QDataStream::Qt_5_5);
+	quint32 Magic;
+	quint16 FormatVersion;
+	qint32 Version;
+	qint32 UserVersion;
+	QStringList Names;
+	s >> Magic >> FormatVersion;
+	if (Magic != BinaryStateMagic || FormatVersion > CurrentBinaryVersion)
+	{
+		return false;
+	}
+
+	s >> Version >> UserVersion >> Names;
+	if (s.status() != QDataStream::Ok)
+	{
+		return false;
+	}
+
+	State.Version = Version;
+	State.UserVersion = UserVersion;
+	if (!readName(s, Names, State.CentralWidget))
+	{
+		return false;
+	}
+
+	quint32 ContainerCount;
+	s >> ContainerCount;
+	State.Containers.clear();
+	for (quint32 i = 0; i < ContainerCount && s.status() == QDataStream::Ok; ++i)
+	{
+		quint8 Tag;
+		quint8 Floating;
+		quint32 NodeCount;
+		DockLayoutContainer Container;
+		s >> Tag >> Floating >> Container.Geometry >> NodeCount;
+		if (Tag != ContainerTag || s.status() != QDataStream::Ok)
+		{
+			return false;
+		}
+
+		Container.Floating = Floating;
+		if (Container.Floating && Container.Geometry.isEmpty())
+		{
+			return false;
+		}
+
+		for (quint32 n = 0; n < NodeCount; ++n)
+		{
+			DockLayoutNode Node;
+			if (!readNode(s, Names, Node))
+			{
+				return false;
+			}
+			Container.Nodes.append(Node);
+		}
+
+		if (!validateNodes(Container.Nodes))
+		{
+			return false;
+		}
+		State.Containers.append(Container);
+	}
+
+	return s.status() == QDataStream::Ok;
+}
+
+
+//============================================================================
+QByteArray CDockStateSerializer::writeXml(const DockLayoutState& State,
+	bool AutoFormatting)
+{
+	QByteArray Data;
+	QXmlStreamWriter s(&Data);
+	s.setAutoFormatting(AutoFormatting);
+	s.writeStartDocument();
+	s.writeStartElement("QtAdvancedDockingSystem");
+	s.writeAttribute("Version", QString::number(State.Version));
+	s.writeAttribute("UserVersion", QString::number(State.UserVersion));
+	s.writeAttribute("Containers", QString::number(State.Containers.count()));
+	if (!State.CentralWidget.isEmpty())
+	{
+		s.writeAttribute("CentralWidget", State.CentralWidget);
+	}
+
+	for (const auto& Container : State.Containers)
+	{
+		s.writeStartElement("Container");
+		s.writeAttribute("Floating", QString::number(Container.Floating ? 1 : 0));
+		if (Container.Floating)
+		{
+#if QT_VERSION < 0x050900
+			s.writeTextElement("Geometry", qByteArrayToHex(Container.Geometry, ' '));
+#else
+			s.writeTextElement("Geometry", Container.Geometry.toHex(' '));
+#endif
+		}
+
+		if (Container.Nodes.isEmpty())
+		{
+			// An empty container still has its empty root splitter
+			s.writeStartElement("Splitter");
+			s.writeAttribute("Orientation", "|");
+			s.writeAttribute("Count", "0");
+			s.writeEmptyElement("Sizes");
+			s.writeEndElement();
+		}
+		else
+		{
+			int Index = 0;
+			writeXmlSubtree(s, Container.Nodes, Index);
+		}
+		s.writeEndElement();
+	}
+
+	s.writeEndElement();
+	s.writeEndDocument();
+	return Data;
+}
+
+
+//============================================================================
+bool CDockStateSerializer::readXml(const QByteArray& Data, DockLayoutState& State)
+{
+	if (Data.isEmpty())
+	{
+		return false;
+	}
+
+	CDockingStateReader s(Data);
+	s.readNextStartElement();
+	if (s.name() != "QtAdvancedDockingSystem")
+	{
+		return false;
+	}
+
+	bool ok;
+	State.Version = s.attributes().value("Version").toInt(&ok);
+	if (!ok)
+	{
+		return false;
+	}
+	s.setFileVersion(State.Version);
+
+	// Older files do not support UserVersion but we still want to load them so
+	// we first test if the attribute exists
+	State.HasUserVersion = !s.attributes().value("UserVersion").isEmpty();
+	if (State.HasUserVersion)
+	{
+		State.UserVersion = s.attributes().value("UserVersion").toInt(&ok);
+		if (!ok)
+		{
+			return false;
+		}
+	}
+	State.CentralWidget = s.attributes().value("CentralWidget").toString();
+
+	State.Containers.clear();
+	while (s.readNextStartElement())
+	{
+		if (s.name() != "Container")
+		{
+			s.skipCurrentElement();
+			continue;
+		}
+
+		DockLayoutContainer Container;
+		if (!readXmlContainer(s, Container) || !validateNodes(Container.Nodes))
+		{
+			return false;
+		}
+		State.Containers.append(Container);
+	}
+
+	return !s.hasError();
+}
+
+
+//============================================================================
+QByteArray CDockStateSerializer::writeState(const DockLayoutState& State,
+	bool Binary, bool Compress, bool AutoFormatting)
+{
+	if (Binary)
+	{
+		return writeBinary(State);
+	}
+
+	QByteArray Data = writeXml(State, AutoFormatting);
+	return Compress ? qCompress(Data, 9) : Data;
+}
+
+
+//============================================================================
+bool CDockStateSerializer::readState(const QByteArray& Data, DockLayoutState& State)
+{
+	if (isBinaryState(Data))
+	{
+		return readBinary(Data, State);
+	}
+
+	return readXml(Data.startsWith("<?xml") ? Data : qUncompress(Data), State);
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockStateSerializer.cpp
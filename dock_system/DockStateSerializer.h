@@ -0,0 +1,145 @@
+#ifndef DockStateSerializerH
+#define DockStateSerializerH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockStateSerializer.h
+/// \date   16.10.2026
+/// \brief  Declaration of the in-memory layout tree and CDockStateSerializer
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "ads_globals.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+namespace ads
+{
+/**
+ * One node of a saved dock container layout.
+ * The nodes of a container are stored flat in pre-order. A splitter node is
+ * followed by its Count child subtrees, an area node is followed by its
+ * Count widget nodes.
+ */
+struct DockLayoutNode
+{
+	enum eNodeType
+	{
+		SplitterNode,
+		AreaNode,
+		WidgetNode
+	};
+
+	eNodeType Type = SplitterNode;
+	int Count = 0;///< number of child subtrees (splitter) or widgets (area)
+	Qt::Orientation Orientation = Qt::Horizontal;///< splitter orientation
+	QList<int> Sizes;///< splitter sizes
+	QString Name;///< current dock widget (area) or object name (widget)
+	int AllowedAreas = -1;///< area allowed areas, -1 if not saved
+	int Flags = -1;///< area flags, -1 if not saved
+	bool Closed = false;///< widget closed state
+};
+
+
+/**
+ * Saved state of a single dock container
+ */
+struct DockLayoutContainer
+{
+	bool Floating = false;
+	QByteArray Geometry;///< floating widget geometry
+	QVector<DockLayoutNode> Nodes;///< empty for an empty root splitter
+};
+
+
+/**
+ * Saved state of the complete dock manager
+ */
+struct DockLayoutState
+{
+	int Version = 0;///< internal file version
+	int UserVersion = 0;
+	bool HasUserVersion = true;///< false for old XML files without user version
+	QString CentralWidget;
+	QVector<DockLayoutContainer> Containers;
+};
+
+
+/**
+ * Reads and writes the compact binary layout format.
+ * The binary format stores tagged splitter, area and widget records. All
+ * dock widget object names are written once into an interned name table
+ * and the records only reference the table index.
+ */
+class ADS_EXPORT CDockStateSerializer
+{
+public:
+	/**
+	 * Returns true, if the given data starts with the binary format magic
+	 */
+	static bool isBinaryState(const QByteArray& Data);
+
+	/**
+	 * Serializes the given layout into the binary format
+	 */
+	static QByteArray writeBinary(const DockLayoutState& State);
+
+	/**
+	 * Parses and validates binary data. Returns false and leaves State in
+	 * an undefined state, if the data is invalid.
+	 */
+	static bool readBinary(const QByteArray& Data, DockLayoutState& State);
+
+	/**
+	 * Parses and validates uncompressed XML state data in a single pass.
+	 * Returns false, if the data is invalid.
+	 */
+	static bool readXml(const QByteArray& Data, DockLayoutState& State);
+
+	/**
+	 * Serializes the given layout into uncompressed XML state data. The
+	 * output is compatible with the widget based XML state format.
+	 */
+	static QByteArray writeXml(const DockLayoutState& State, bool AutoFormatting);
+
+	/**
+	 * Serializes the given layout into binary data or into optionally
+	 * compressed XML data
+	 */
+	static QByteArray writeState(const DockLayoutState& State, bool Binary,
+		bool Compress, bool AutoFormatting);
+
+	/**
+	 * Parses binary, XML or compressed XML state data. Only the structure
+	 * of the data is validated. The checks that depend on the registered
+	 * dock widgets are done by the dock manager.
+	 */
+	static bool readState(const QByteArray& Data, DockLayoutState& State);
+};
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockStateSerializerH
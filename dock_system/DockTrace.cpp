@@ -0,0 +1,286 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockTrace.cpp
+/// \date   16.10.2026
+/// \brief  Implementation of CDockTrace
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "DockTrace.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+namespace ads
+{
+namespace
+{
+/**
+ * A single complete event. The fields are atomics because the exporting
+ * thread may read a slot while the recording thread overwrites it.
+ */
+struct TraceEvent
+{
+	std::atomic<const char*> Name{nullptr};
+	std::atomic<qint64> Begin{0};
+	std::atomic<qint64> End{0};
+};
+
+
+/**
+ * Ring buffer of one thread. Only the owning thread writes events and
+ * advances Head.
+ */
+struct ThreadTraceBuffer
+{
+	int ThreadId = 0;
+	QString ThreadName;
+	std::atomic<quint64> Head{0};///< number of events recorded so far
+	std::atomic<quint64> Tail{0};///< first event that has not been cleared
+	TraceEvent Events[CDockTrace::RingBufferSize];
+};
+
+
+/**
+ * Owns the buffers of all threads that recorded events. The buffers are
+ * never freed so that exporting after a thread finished is still possible.
+ */
+struct TraceRegistry
+{
+	QMutex Mutex;
+	std::vector<std::unique_ptr<ThreadTraceBuffer>> Buffers;
+};
+
+Q_GLOBAL_STATIC(TraceRegistry, traceRegistry)
+std::atomic<bool> TraceEnabled{qEnvironmentVariableIsSet("ADS_TRACE")};
+
+
+//============================================================================
+ThreadTraceBuffer* registerThreadBuffer()
+{
+	auto Registry = traceRegistry();
+	if (!Registry)
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<ThreadTraceBuffer> Buffer(new ThreadTraceBuffer);
+	QThread* Thread = QThread::currentThread();
+	Buffer->ThreadName = Thread->objectName();
+	QMutexLocker Locker(&Registry->Mutex);
+	Buffer->ThreadId = int(Registry->Buffers.size()) + 1;
+	if (Buffer->ThreadName.isEmpty())
+	{
+		bool MainThread = QCoreApplication::instance()
+			&& QCoreApplication::instance()->thread() == Thread;
+		Buffer->ThreadName = MainThread ? QStringLiteral("Main thread")
+			: QStringLiteral("Thread %1").arg(Buffer->ThreadId);
+	}
+	Registry->Buffers.push_back(std::move(Buffer));
+	return Registry->Buffers.back().get();
+}
+
+
+//============================================================================
+ThreadTraceBuffer* threadBuffer()
+{
+	thread_local ThreadTraceBuffer* Buffer = registerThreadBuffer();
+	return Buffer;
+}
+} // namespace
+
+
+//============================================================================
+bool CDockTrace::isCompiledIn()
+{
+#ifdef ADS_TRACE_ENABLED
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//============================================================================
+void CDockTrace::setEnabled(bool Enabled)
+{
+	TraceEnabled.store(Enabled, std::memory_order_relaxed);
+}
+
+
+//============================================================================
+bool CDockTrace::isEnabled()
+{
+	return TraceEnabled.load(std::memory_order_relaxed);
+}
+
+
+//============================================================================
+void CDockTrace::clear()
+{
+	auto Registry = traceRegistry();
+	if (!Registry)
+	{
+		return;
+	}
+
+	QMutexLocker Locker(&Registry->Mutex);
+	for (const auto& Buffer : Registry->Buffers)
+	{
+		Buffer->Tail.store(Buffer->Head.load(std::memory_order_acquire),
+			std::memory_order_relaxed);
+	}
+}
+
+
+//============================================================================
+qint64 CDockTrace::now()
+{
+	static const QElapsedTimer Clock = []()
+	{
+		QElapsedTimer Timer;
+		Timer.start();
+		return Timer;
+	}();
+	return Clock.nsecsElapsed();
+}
+
+
+//============================================================================
+void CDockTrace::record(const char* Name, qint64 Begin, qint64 End)
+{
+	auto Buffer = threadBuffer();
+	if (!Buffer)
+	{
+		return;
+	}
+
+	quint64 Head = Buffer->Head.load(std::memory_order_relaxed);
+	TraceEvent& Event = Buffer->Events[Head % RingBufferSize];
+	// Pairs with the acquire fence in toChromeTrace(). An exporter that
+	// reads any of the following slot stores also sees the Head value of
+	// the previous record() call and thus detects the overwritten slot.
+	std::atomic_thread_fence(std::memory_order_release);
+	Event.Name.store(Name, std::memory_order_relaxed);
+	Event.Begin.store(Begin, std::memory_order_relaxed);
+	Event.End.store(End, std::memory_order_relaxed);
+	Buffer->Head.store(Head + 1, std::memory_order_release);
+}
+
+
+//============================================================================
+QByteArray CDockTrace::toChromeTrace()
+{
+	QJsonArray Events;
+	auto Registry = traceRegistry();
+	if (Registry)
+	{
+		const int Pid = int(QCoreApplication::applicationPid());
+		QMutexLocker Locker(&Registry->Mutex);
+		for (const auto& Buffer : Registry->Buffers)
+		{
+			QJsonObject ThreadName;
+			ThreadName["name"] = "thread_name";
+			ThreadName["ph"] = "M";
+			ThreadName["pid"] = Pid;
+			ThreadName["tid"] = Buffer->ThreadId;
+			ThreadName["args"] = QJsonObject{{"name", Buffer->ThreadName}};
+			Events.append(ThreadName);
+
+			quint64 Head = Buffer->Head.load(std::memory_order_acquire);
+			quint64 First = Buffer->Tail.load(std::memory_order_relaxed);
+			if (Head > RingBufferSize && First < Head - RingBufferSize)
+			{
+				First = Head - RingBufferSize;
+			}
+
+			// Copy the events first and then drop the ones the recording
+			// thread may have overwritten while we were copying
+			struct Copy { const char* Name; qint64 Begin; qint64 End; };
+			std::vector<Copy> Copies;
+			Copies.reserve(Head - First);
+			for (quint64 i = First; i < Head; ++i)
+			{
+				const TraceEvent& Event = Buffer->Events[i % RingBufferSize];
+				Copies.push_back({Event.Name.load(std::memory_order_relaxed),
+					Event.Begin.load(std::memory_order_relaxed),
+					Event.End.load(std::memory_order_relaxed)});
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			quint64 Written = Buffer->Head.load(std::memory_order_relaxed);
+			for (quint64 i = First; i < Head; ++i)
+			{
+				if (i + RingBufferSize <= Written)
+				{
+					continue;
+				}
+
+				const Copy& Event = Copies[i - First];
+				QJsonObject Object;
+				Object["name"] = QString::fromUtf8(Event.Name);
+				Object["cat"] = "ads";
+				Object["ph"] = "X";
+				Object["ts"] = Event.Begin / 1000.0;
+				Object["dur"] = (Event.End - Event.Begin) / 1000.0;
+				Object["pid"] = Pid;
+				Object["tid"] = Buffer->ThreadId;
+				Events.append(Object);
+			}
+		}
+	}
+
+	QJsonObject Trace;
+	Trace["traceEvents"] = Events;
+	Trace["displayTimeUnit"] = "ms";
+	return QJsonDocument(Trace).toJson(QJsonDocument::Compact);
+}
+
+
+//============================================================================
+bool CDockTrace::writeChromeTrace(const QString& FileName)
+{
+	QFile File(FileName);
+	if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		return false;
+	}
+
+	const QByteArray Data = toChromeTrace();
+	return File.write(Data) == Data.size();
+}
+} // namespace ads
+
+//---------------------------------------------------------------------------
+// EOF DockTrace.cpp
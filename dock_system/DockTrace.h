@@ -0,0 +1,152 @@
+#ifndef DockTraceH
+#define DockTraceH
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   DockTrace.h
+/// \date   16.10.2026
+/// \brief  Declaration of the scoped trace points and CDockTrace
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include "ads_globals.h"
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Trace points are only compiled in, if ADS_TRACE_ENABLED is defined
+ * (CMake option ADS_ENABLE_TRACING, qmake CONFIG += adsTrace). Without it
+ * ADS_TRACE_SCOPE expands to nothing and costs nothing.
+ * \code
+ * void CDockAreaWidget::setCurrentIndex(int index)
+ * {
+ *     ADS_TRACE_SCOPE("CDockAreaWidget::setCurrentIndex");
+ *     ...
+ * }
+ * \endcode
+ * The name must be a string literal or any other string with static
+ * storage duration because only the pointer is recorded.
+ */
+#ifdef ADS_TRACE_ENABLED
+#define ADS_TRACE_CONCAT_IMPL(a, b) a##b
+#define ADS_TRACE_CONCAT(a, b) ADS_TRACE_CONCAT_IMPL(a, b)
+#define ADS_TRACE_SCOPE(Name) \
+	ads::CDockTraceScope ADS_TRACE_CONCAT(AdsTraceScope, __LINE__)(Name)
+#else
+#define ADS_TRACE_SCOPE(Name) (void)0
+#endif
+
+namespace ads
+{
+/**
+ * Records the trace events of the ADS_TRACE_SCOPE trace points.
+ * Each thread records into its own fixed size ring buffer. Recording is
+ * lock free - only the first event of a new thread registers its buffer.
+ * If a buffer is full, the oldest events are overwritten. Recording is
+ * disabled by default and needs to be switched on with setEnabled().
+ * The recorded events can be exported in the Chrome trace event format
+ * that can be loaded into chrome://tracing or Perfetto.
+ */
+class ADS_EXPORT CDockTrace
+{
+public:
+	enum
+	{
+		RingBufferSize = 8192///< number of events per thread
+	};
+
+	/**
+	 * Returns true, if the library has been compiled with trace points
+	 */
+	static bool isCompiledIn();
+
+	/**
+	 * Enables or disables recording of trace events
+	 */
+	static void setEnabled(bool Enabled);
+
+	/**
+	 * Returns true, if recording is enabled
+	 */
+	static bool isEnabled();
+
+	/**
+	 * Discards all recorded events
+	 */
+	static void clear();
+
+	/**
+	 * Returns the monotonic trace clock in nanoseconds
+	 */
+	static qint64 now();
+
+	/**
+	 * Records a complete event into the ring buffer of the calling thread.
+	 * Begin and End are values returned by now().
+	 */
+	static void record(const char* Name, qint64 Begin, qint64 End);
+
+	/**
+	 * Returns all recorded events as Chrome trace event JSON
+	 */
+	static QByteArray toChromeTrace();
+
+	/**
+	 * Writes the recorded events as Chrome trace event JSON into the
+	 * given file. Returns false, if the file could not be written.
+	 */
+	static bool writeChromeTrace(const QString& FileName);
+};
+
+
+/**
+ * Records the lifetime of a scope as one complete trace event.
+ * Use the ADS_TRACE_SCOPE macro instead of using this class directly.
+ */
+class CDockTraceScope
+{
+public:
+	explicit CDockTraceScope(const char* Name)
+		: Name(Name),
+		  Begin(CDockTrace::isEnabled() ? CDockTrace::now() : -1)
+	{
+	}
+
+	~CDockTraceScope()
+	{
+		if (Begin >= 0)
+		{
+			CDockTrace::record(Name, Begin, CDockTrace::now());
+		}
+	}
+
+private:
+	Q_DISABLE_COPY(CDockTraceScope)
+	const char* Name;
+	qint64 Begin;
+};
+} // namespace ads
+
+//-----------------------------------------------------------------------------
+#endif // DockTraceH
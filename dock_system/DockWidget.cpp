@@ -41,8 +41,10 @@
 #include <QTextStream>
 #include <QPointer>
 #include <QEvent>
+#include <QElapsedTimer>
 #include <QDebug>
 #include <QToolBar>
+#include <QTimer>
 #include <QXmlStreamWriter>
 #include <QWindow>
 
@@ -58,10 +60,19 @@
 #include "DockComponentsFactory.h"
 #include "DockAreaTitleBar.h"
 #include "ads_globals.h"
+#include "DockMetrics.h"
 
 
 namespace ads
 {
+/**
+ * A content that repaints continuously, e.g. a video or a plot, renders
+ * its drag preview at most once per interval
+ */
+static const int PreviewUpdateInterval = 250;// milliseconds
+
+class CDockWidgetPreviewObserver;
+
 /**
  * Private data class of CDockWidget class (pimpl)
  */
@@ -86,11 +97,65 @@ struct DockWidgetPrivate
 	QList<QAction*> TitleBarActions;
 	CDockWidget::eMinimumSizeHintMode MinimumSizeHintMode = CDockWidget::MinimumSizeHintFromDockWidget;
 	CDockWidget::eViewType view_type = CDockWidget::VIEW_SETTING;
+	std::function<QPixmap(const QSize&)> PreviewPixmapHandler;
+	QPixmap PreviewPixmap;///< cached drag preview
+	QSize PreviewMaxSize;///< maximum size the cached preview was created for
+	QSize PreviewSize;///< dock widget size the cached preview was created for
+	bool PreviewOutdated = true;
+	QElapsedTimer PreviewAge;///< started when the cached preview was created
+	CDockWidgetPreviewObserver* PreviewObserver = nullptr;
+	bool Suspended = false;
+	QTimer* SuspendTimer = nullptr;
+	QPointer<QWindow> SuspendWindow;///< window whose state changes are watched
+	QMetaObject::Connection SuspendWindowConnection;
+	std::function<QWidget*()> WidgetFactory;
+	CDockWidget::eInsertMode FactoryInsertMode = CDockWidget::AutoScrollArea;
+	int WidgetReleaseDelay = -1;///< -1 keeps factory content when closed
+	QTimer* WidgetReleaseTimer = nullptr;
 	/**
 	 * Private data constructor
 	 */
 	DockWidgetPrivate(CDockWidget* _public);
 
+	/**
+	 * Creates the content widget with the widget factory, if the content
+	 * does not exist yet
+	 */
+	void createWidgetFromFactory();
+
+	/**
+	 * Starts or stops the release timer of factory created content
+	 * depending on the closed state
+	 */
+	void updateWidgetRelease();
+
+	/**
+	 * Returns true, if the content is not visible to the user - the dock
+	 * widget is hidden, not the current tab or its window is minimized
+	 */
+	bool isContentHidden() const
+	{
+		return !_this->isVisible() || _this->window()->isMinimized();
+	}
+
+	/**
+	 * Checks the visibility of the content. Hidden content is suspended
+	 * after the content suspend delay of the dock manager, visible content
+	 * is resumed immediately.
+	 */
+	void updateSuspendState();
+
+	/**
+	 * Sets the suspended state and emits suspended() or resumed()
+	 */
+	void setSuspended(bool Suspend);
+
+	/**
+	 * Connects to the window state changes of the current top level window
+	 * to detect minimizing
+	 */
+	void watchWindowState();
+
 	/**
 	 * Show dock widget
 	 */
@@ -120,6 +185,78 @@ struct DockWidgetPrivate
 };
 // struct DockWidgetPrivate
 
+
+/**
+ * Event filter for the content widget of a dock widget and all its child
+ * widgets. It marks the cached drag preview as outdated whenever one of
+ * these widgets is repainted.
+ */
+class CDockWidgetPreviewObserver : public QObject
+{
+public:
+	DockWidgetPrivate* d;
+
+	CDockWidgetPreviewObserver(DockWidgetPrivate* Private, QObject* Parent)
+		: QObject(Parent),
+		  d(Private)
+	{}
+
+	/**
+	 * Installs or removes the filter for the given object and all its
+	 * child widgets
+	 */
+	void watch(QObject* Object, bool Enable)
+	{
+		if (Enable)
+		{
+			Object->installEventFilter(this);
+		}
+		else
+		{
+			Object->removeEventFilter(this);
+		}
+
+		for (auto Child : Object->findChildren<QWidget*>())
+		{
+			if (Enable)
+			{
+				Child->installEventFilter(this);
+			}
+			else
+			{
+				Child->removeEventFilter(this);
+			}
+		}
+	}
+
+	virtual bool eventFilter(QObject* Watched, QEvent* Event) override
+	{
+		switch (Event->type())
+		{
+		case QEvent::Paint:
+			d->PreviewOutdated = true;
+			break;
+
+		// Child widgets that are created later are watched, too
+		case QEvent::ChildAdded:
+		case QEvent::ChildRemoved:
+			{
+				QObject* Child = static_cast<QChildEvent*>(Event)->child();
+				if (Child->isWidgetType())
+				{
+					watch(Child, Event->type() == QEvent::ChildAdded);
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+		return QObject::eventFilter(Watched, Event);
+	}
+};
+
+
 //============================================================================
 DockWidgetPrivate::DockWidgetPrivate(CDockWidget* _public) :
 	_this(_public)
@@ -128,6 +265,133 @@ DockWidgetPrivate::DockWidgetPrivate(CDockWidget* _public) :
 }
 
 
+//============================================================================
+void DockWidgetPrivate::createWidgetFromFactory()
+{
+	if (Widget || !WidgetFactory)
+	{
+		return;
+	}
+
+	QWidget* Content = WidgetFactory();
+	if (Content)
+	{
+		_this->setWidget(Content, FactoryInsertMode);
+	}
+}
+
+
+//============================================================================
+void DockWidgetPrivate::updateWidgetRelease()
+{
+	if (!Closed || !WidgetFactory || WidgetReleaseDelay < 0)
+	{
+		if (WidgetReleaseTimer)
+		{
+			WidgetReleaseTimer->stop();
+		}
+		return;
+	}
+
+	if (!WidgetReleaseTimer)
+	{
+		WidgetReleaseTimer = new QTimer(_this);
+		WidgetReleaseTimer->setSingleShot(true);
+		QObject::connect(WidgetReleaseTimer, &QTimer::timeout, [this]()
+		{
+			// The factory recreates the content on the next show
+			if (Closed && WidgetFactory && Widget)
+			{
+				internal::deleteLater(_this->takeWidget());
+			}
+		});
+	}
+	WidgetReleaseTimer->start(WidgetReleaseDelay);
+}
+
+
+//============================================================================
+void DockWidgetPrivate::updateSuspendState()
+{
+	if (!isContentHidden())
+	{
+		if (SuspendTimer)
+		{
+			SuspendTimer->stop();
+		}
+		setSuspended(false);
+		return;
+	}
+
+	if (Suspended)
+	{
+		return;
+	}
+
+	// The delay prevents suspend / resume cycles if the user quickly
+	// switches through the tabs
+	if (!SuspendTimer)
+	{
+		SuspendTimer = new QTimer(_this);
+		SuspendTimer->setSingleShot(true);
+		QObject::connect(SuspendTimer, &QTimer::timeout, [this]()
+		{
+			setSuspended(isContentHidden());
+		});
+	}
+	if (!SuspendTimer->isActive())
+	{
+		SuspendTimer->start(CDockManager::contentSuspendDelay());
+	}
+}
+
+
+//============================================================================
+void DockWidgetPrivate::setSuspended(bool Suspend)
+{
+	if (Suspended == Suspend)
+	{
+		return;
+	}
+
+	Suspended = Suspend;
+	if (Suspended)
+	{
+		emit _this->suspended();
+	}
+	else
+	{
+		emit _this->resumed();
+	}
+}
+
+
+//============================================================================
+void DockWidgetPrivate::watchWindowState()
+{
+	QWindow* Window = _this->window()->windowHandle();
+	if (Window == SuspendWindow)
+	{
+		return;
+	}
+
+	QObject::disconnect(SuspendWindowConnection);
+	SuspendWindow = Window;
+	if (Window)
+	{
+		SuspendWindowConnection = QObject::connect(Window, &QWindow::windowStateChanged,
+			_this, [this](Qt::WindowState)
+			{
+				// The widget window state is updated after the signal
+				QTimer::singleShot(0, _this, [this]()
+				{
+					updateSuspendState();
+				});
+			});
+	}
+}
+
+
 //============================================================================
 void DockWidgetPrivate::showDockWidget()
 {
@@ -290,6 +554,40 @@ void CDockWidget::setWidget(QWidget* widget, eInsertMode InsertMode)
 
 	d->Widget = widget;
 	d->Widget->setProperty("dockWidgetContent", true);
+	if (!d->PreviewObserver)
+	{
+		d->PreviewObserver = new CDockWidgetPreviewObserver(d, this);
+	}
+	d->PreviewObserver->watch(d->Widget, true);
+	d->PreviewOutdated = true;
+}
+
+
+//============================================================================
+void CDockWidget::setWidgetFactory(std::function<QWidget*()> Factory, eInsertMode InsertMode)
+{
+	d->WidgetFactory = Factory;
+	d->FactoryInsertMode = InsertMode;
+	if (isVisible())
+	{
+		d->createWidgetFromFactory();
+	}
+	d->updateWidgetRelease();
+}
+
+
+//============================================================================
+void CDockWidget::setWidgetReleaseDelay(int Milliseconds)
+{
+	d->WidgetReleaseDelay = Milliseconds;
+	d->updateWidgetRelease();
+}
+
+
+//============================================================================
+int CDockWidget::widgetReleaseDelay() const
+{
+	return d->WidgetReleaseDelay;
 }
 
 
@@ -314,8 +612,13 @@ QWidget* CDockWidget::takeWidget()
 
 	if (w)
 	{
+		if (d->PreviewObserver)
+		{
+			d->PreviewObserver->watch(w, false);
+		}
 		w->setParent(nullptr);
 	}
+	d->PreviewOutdated = true;
     return w;
 }
 
@@ -334,6 +637,53 @@ CDockWidgetTab* CDockWidget::tabWidget() const
 }
 
 
+//============================================================================
+void CDockWidget::setPreviewPixmapHandler(std::function<QPixmap(const QSize&)> handler)
+{
+	d->PreviewPixmapHandler = handler;
+	invalidatePreviewPixmap();
+}
+
+
+//============================================================================
+QPixmap CDockWidget::previewPixmap(const QSize& MaxSize)
+{
+	if (d->PreviewPixmapHandler)
+	{
+		QPixmap Pixmap = d->PreviewPixmapHandler(MaxSize);
+		if (!Pixmap.isNull())
+		{
+			return Pixmap;
+		}
+	}
+
+	// The cached preview is valid as long as the content has not been
+	// repainted and the dock widget has not been resized. Repaints only
+	// invalidate a preview that is older than the update interval.
+	bool Outdated = d->PreviewOutdated && (!d->PreviewAge.isValid()
+		|| d->PreviewAge.hasExpired(PreviewUpdateInterval));
+	if (Outdated || d->PreviewPixmap.isNull()
+	 || d->PreviewMaxSize != MaxSize || d->PreviewSize != size())
+	{
+		d->PreviewPixmap = internal::createPreviewPixmap(this, MaxSize);
+		d->PreviewAge.start();
+		d->PreviewMaxSize = MaxSize;
+		d->PreviewSize = size();
+		// Rendering itself sends paint events to the content widget
+		d->PreviewOutdated = false;
+	}
+	return d->PreviewPixmap;
+}
+
+
+//============================================================================
+void CDockWidget::invalidatePreviewPixmap()
+{
+	d->PreviewOutdated = true;
+	d->PreviewPixmap = QPixmap();
+}
+
+
 //============================================================================
 void CDockWidget::setFeatures(DockWidgetFeatures features)
 {
@@ -543,6 +893,7 @@ void CDockWidget::toggleViewInternal(bool Open)
 		FloatingContainer->updateWindowTitle();
 	}
 
+	d->updateWidgetRelease();
 	if (!Open)
 	{
 		emit closed();
@@ -557,6 +908,15 @@ void CDockWidget::setDockArea(CDockAreaWidget* DockArea)
 	d->DockArea = DockArea;
 	d->ToggleViewAction->setChecked(DockArea != nullptr && !this->isClosed());
 	setParent(DockArea);
+	// Content that is inserted as a hidden tab never receives a hide event
+	d->updateSuspendState();
+}
+
+
+//============================================================================
+bool CDockWidget::isSuspended() const
+{
+	return d->Suspended;
 }
 
 
@@ -574,6 +934,10 @@ void CDockWidget::saveState(QXmlStreamWriter& s) const
 void CDockWidget::flagAsUnassigned()
 {
 	d->Closed = true;
+	if (d->DockArea)
+	{
+		d->DockArea->invalidateOpenedDockWidgets();
+	}
 	setParent(d->DockManager);
 	setVisible(false);
 	setDockArea(nullptr);
@@ -588,10 +952,16 @@ bool CDockWidget::event(QEvent *e)
 	{
 	case QEvent::Hide:
 		emit visibilityChanged(false);
+		d->updateSuspendState();
 		break;
 
 	case QEvent::Show:
+		// Factory content is created when the dock widget is shown the first
+		// time, e.g. when its tab becomes the current tab
+		d->createWidgetFromFactory();
 		emit visibilityChanged(geometry().right() >= 0 && geometry().bottom() >= 0);
+		d->watchWindowState();
+		d->updateSuspendState();
         break;
 
 	case QEvent::WindowTitleChange :
@@ -814,6 +1184,12 @@ void CDockWidget::emitTopLevelChanged(bool Floating)
 void CDockWidget::setClosedState(bool Closed)
 {
 	d->Closed = Closed;
+	// The dock area caches its opened dock widgets
+	if (d->DockArea)
+	{
+		d->DockArea->invalidateOpenedDockWidgets();
+	}
+	d->updateWidgetRelease();
 }
 
 
@@ -846,7 +1222,7 @@ void CDockWidget::setFloating()
 void CDockWidget::deleteDockWidget()
 {
 	dockManager()->removeDockWidget(this);
-	deleteLater();
+	internal::deleteLater(this);
 	d->Closed = true;
 }
 
@@ -881,7 +1257,7 @@ bool CDockWidget::closeDockWidgetInternal(bool ForceClose)
 					CFloatingDockContainer*>(this);
 			if (FloatingWidget->dockWidgets().count() == 1)
 			{
-				FloatingWidget->deleteLater();
+				internal::deleteLater(FloatingWidget);
 			}
 			else
 			{
@@ -999,7 +1375,9 @@ void CDockWidget::raise()
 }
 
 void CDockWidget::set_tab_color(QString color) {
-	d->TabWidget->setStyleSheet("ads--CDockWidgetTab[activeTab=""true""]{ background:" + color + ";border-color:" + color+ ";}");
+	// The tab paints the color itself - a style sheet for each tab would be
+	// parsed and polished separately for every tab
+	d->TabWidget->setActiveTabColor(QColor(color));
 }
 void CDockWidget::set_tab_rgb(int r, int g, int b, int a) {
 	tab_color_ = QColor(r, g, b, a);
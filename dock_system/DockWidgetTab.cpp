@@ -41,6 +41,7 @@
 #include <QDebug>
 #include <QToolButton>
 #include <QPushButton>
+#include <QPainter>
 
 #include "ads_globals.h"
 #include "DockWidget.h"
@@ -78,6 +79,7 @@ struct DockWidgetTabPrivate
 	QPushButton* pull_down_btn = nullptr;
 	QSpacerItem* IconTextSpacer;
 	QPoint TabDragStartPosition;
+	QColor ActiveTabColor;///< background and border color of the active tab
 
 	/**
 	 * Private data constructor
@@ -535,7 +537,14 @@ void CDockWidgetTab::setActiveTab(bool active)
 		{
 			if (UpdateFocusStyle)
 			{
-				updateStyle();
+				if (CDockManager::testConfigFlag(CDockManager::PaintedFocusHighlighting))
+				{
+					updateFocusHighlight();
+				}
+				else
+				{
+					updateStyle();
+				}
 			}
 			return;
 		}
@@ -725,6 +734,83 @@ void CDockWidgetTab::setElideMode(Qt::TextElideMode mode)
 }
 
 
+//============================================================================
+void CDockWidgetTab::setActiveTabColor(const QColor& Color)
+{
+	if (Color == d->ActiveTabColor)
+	{
+		return;
+	}
+
+	d->ActiveTabColor = Color;
+	if (d->IsActiveTab)
+	{
+		update();
+	}
+}
+
+
+//============================================================================
+QColor CDockWidgetTab::activeTabColor() const
+{
+	return d->ActiveTabColor;
+}
+
+
+//============================================================================
+void CDockWidgetTab::paintEvent(QPaintEvent* ev)
+{
+	Super::paintEvent(ev);
+	// The active tab color replaces the background and the border of the
+	// style sheet. Painting it here avoids a style sheet for each tab.
+	// A tab color has precedence over the painted focus highlight, like the
+	// tab style sheet had precedence over the global focus style sheet.
+	QColor Color;
+	if (d->IsActiveTab && d->ActiveTabColor.isValid())
+	{
+		Color = d->ActiveTabColor;
+	}
+	else if (isFocusHighlighted())
+	{
+		Color = palette().color(QPalette::Highlight);
+	}
+
+	if (!Color.isValid())
+	{
+		return;
+	}
+
+	QPainter Painter(this);
+	Painter.fillRect(rect(), Color);
+}
+
+
+//============================================================================
+bool CDockWidgetTab::isFocusHighlighted() const
+{
+	return CDockManager::testConfigFlag(CDockManager::PaintedFocusHighlighting)
+		&& property("focused").toBool();
+}
+
+
+//============================================================================
+void CDockWidgetTab::updateFocusHighlight()
+{
+	// The label is a child widget that is painted over the highlight. A label
+	// color rule of the style sheet overrides the foreground role, so the
+	// label gets a focused property, too. Only the label is repolished - it
+	// has no children, so this is cheap.
+	bool Focused = isFocusHighlighted();
+	d->TitleLabel->setForegroundRole(Focused ? QPalette::Light : QPalette::WindowText);
+	if (d->TitleLabel->property("focused").toBool() != Focused)
+	{
+		d->TitleLabel->setProperty("focused", Focused);
+		internal::repolishStyle(d->TitleLabel, internal::RepolishIgnoreChildren);
+	}
+	update();
+}
+
+
 //============================================================================
 void CDockWidgetTab::updateStyle()
 {
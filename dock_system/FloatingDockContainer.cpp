@@ -29,8 +29,6 @@
 #include "FloatingDockContainer.h"
 
 #include <iostream>
-#include <Windows.h>
-#include <windowsx.h>
 #include <QBoxLayout>
 #include <QApplication>
 #include <QDesktopWidget>
@@ -49,10 +47,16 @@
 #include "DockManager.h"
 #include "DockWidget.h"
 #include "DockOverlay.h"
+#include "DockStateSerializer.h"
+#include "DockDragUpdateScheduler.h"
+#include "DockDragSession.h"
+#include "DockTrace.h"
+#include "DockMetrics.h"
 #include "main_title_bar.hpp"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
+#include <windowsx.h>
 #ifdef _MSC_VER
 #pragma comment(lib, "User32.lib")
 #endif
@@ -382,6 +386,8 @@ struct FloatingDockContainerPrivate
 	QToolBar* toolbar_ = nullptr;
 	bool show_toolbar_ = false;
 	QBoxLayout* layout_ = nullptr;
+	CDockDragUpdateScheduler DropOverlayUpdates;
+	CDockDragSession DragSession;
 #ifdef Q_OS_LINUX
     QWidget* MouseEventHandler = nullptr;
     CFloatingWidgetTitleBar* TitleBar = nullptr;
@@ -414,6 +420,13 @@ struct FloatingDockContainerPrivate
 	void setState(eDragState StateId)
 	{
 		DraggingState = StateId;
+		// A drag session and pending overlay updates only live while the
+		// widget is dragged around
+		if (StateId != DraggingFloatingWidget)
+		{
+			DropOverlayUpdates.cancel();
+			DragSession.end();
+		}
 	}
 
 	void setWindowTitle(const QString &Text)
@@ -466,7 +479,11 @@ struct FloatingDockContainerPrivate
 //============================================================================
 FloatingDockContainerPrivate::FloatingDockContainerPrivate(
     CFloatingDockContainer *_public) :
-	_this(_public)
+	_this(_public),
+	DropOverlayUpdates(_public, [this](const QPoint& GlobalPos)
+	{
+		updateDropOverlays(GlobalPos);
+	})
 {
 
 }
@@ -474,6 +491,8 @@ FloatingDockContainerPrivate::FloatingDockContainerPrivate(
 //============================================================================
 void FloatingDockContainerPrivate::titleMouseReleaseEvent()
 {
+	// The drop must be evaluated with the overlays of the latest position
+	DropOverlayUpdates.flush();
 	setState(DraggingInactive);
 	if (!DropContainer)
 	{
@@ -517,35 +536,17 @@ void FloatingDockContainerPrivate::titleMouseReleaseEvent()
 //============================================================================
 void FloatingDockContainerPrivate::updateDropOverlays(const QPoint &GlobalPos)
 {
+	ADS_TRACE_SCOPE("FloatingDockContainerPrivate::updateDropOverlays");
 	if (!_this->isVisible() || !DockManager)
 	{
 		return;
 	}
 
-	auto Containers = DockManager->dockContainers();
-	CDockContainerWidget *TopContainer = nullptr;
-	for (auto ContainerWidget : Containers)
+	if (!DragSession.isActive())
 	{
-		if (!ContainerWidget->isVisible())
-		{
-			continue;
-		}
-
-		if (DockContainer == ContainerWidget)
-		{
-			continue;
-		}
-
-		QPoint MappedPos = ContainerWidget->mapFromGlobal(GlobalPos);
-		if (ContainerWidget->rect().contains(MappedPos))
-		{
-			if (!TopContainer || ContainerWidget->isInFrontOf(TopContainer))
-			{
-				TopContainer = ContainerWidget;
-			}
-		}
+		DragSession.begin(DockManager, DockContainer);
 	}
-
+	CDockContainerWidget *TopContainer = DragSession.containerAt(GlobalPos);
 	DropContainer = TopContainer;
 	auto ContainerOverlay = DockManager->containerOverlay();
 	auto DockAreaOverlay = DockManager->dockAreaOverlay();
@@ -562,7 +563,7 @@ void FloatingDockContainerPrivate::updateDropOverlays(const QPoint &GlobalPos)
 	    VisibleDockAreas > 1 ? OuterDockAreas : AllDockAreas);
 	DockWidgetArea ContainerArea = ContainerOverlay->showOverlay(TopContainer);
 	ContainerOverlay->enableDropPreview(ContainerArea != InvalidDockWidgetArea);
-	auto DockArea = TopContainer->dockAreaAt(GlobalPos);
+	auto DockArea = DragSession.dockAreaAt(TopContainer, GlobalPos);
 	if (DockArea && DockArea->isVisible() && VisibleDockAreas > 0)
 	{
 		DockAreaOverlay->enableDropPreview(true);
@@ -596,6 +597,7 @@ void FloatingDockContainerPrivate::updateDropOverlays(const QPoint &GlobalPos)
 void FloatingDockContainerPrivate::handleEscapeKey()
 {
 	ADS_PRINT("FloatingDockContainerPrivate::handleEscapeKey()");
+	DropOverlayUpdates.cancel();
 	setState(DraggingInactive);
 	DockManager->containerOverlay()->hideOverlay();
 	DockManager->dockAreaOverlay()->hideOverlay();
@@ -607,6 +609,7 @@ CFloatingDockContainer::CFloatingDockContainer(CDockManager *DockManager) :
 	tFloatingWidgetBase(DockManager),
 	d(new FloatingDockContainerPrivate(this))
 {
+	CDockMetrics::increment(FloatingWidgetsCreated);
 	d->DockManager = DockManager;
 	d->DockContainer = new CDockContainerWidget(DockManager, this);
 	connect(d->DockContainer, SIGNAL(dockAreasAdded()), this,
@@ -683,6 +686,7 @@ CFloatingDockContainer::CFloatingDockContainer(CDockWidget *DockWidget) :
 CFloatingDockContainer::~CFloatingDockContainer()
 {
 	ADS_PRINT("~CFloatingDockContainer");
+	CDockMetrics::increment(FloatingWidgetsDeleted);
 	if (d->DockManager)
 	{
 		d->DockManager->del_toolbar(this);
@@ -739,7 +743,7 @@ bool CFloatingDockContainer::nativeEvent(const QByteArray &eventType, void *mess
 		{
 			if (d->isState(DraggingFloatingWidget))
 			{
-				d->updateDropOverlays(QCursor::pos());
+				d->DropOverlayUpdates.schedule(QCursor::pos());
 			}
 		}
 		break;
@@ -762,7 +766,7 @@ bool CFloatingDockContainer::nativeEvent(const QByteArray &eventType, void *mess
 			 {
 				ADS_PRINT("CFloatingDockContainer::nativeEvent WM_ENTERSIZEMOVE");
 				d->setState(DraggingFloatingWidget);
-				d->updateDropOverlays(QCursor::pos());
+				d->DropOverlayUpdates.schedule(QCursor::pos());
 			 }
 			 break;
 
@@ -978,11 +982,11 @@ void CFloatingDockContainer::moveFloating()
 	{
 	case DraggingMousePressed:
 		d->setState(DraggingFloatingWidget);
-		d->updateDropOverlays(QCursor::pos());
+		d->DropOverlayUpdates.schedule(QCursor::pos());
 		break;
 
 	case DraggingFloatingWidget:
-		d->updateDropOverlays(QCursor::pos());
+		d->DropOverlayUpdates.schedule(QCursor::pos());
 #ifdef Q_OS_MACOS
 		// In OSX when hiding the DockAreaOverlay the application would set
 		// the main window as the active window for some reason. This fixes
@@ -1091,6 +1095,28 @@ bool CFloatingDockContainer::restoreState(CDockingStateReader &Stream,
 	return true;
 }
 
+
+//============================================================================
+void CFloatingDockContainer::restoreState(const DockLayoutContainer& State)
+{
+	d->DockContainer->restoreState(State);
+	onDockAreasAddedOrRemoved();
+#ifdef Q_OS_LINUX
+	if(d->TitleBar)
+	{
+		d->TitleBar->setMaximizedIcon(windowState() == Qt::WindowMaximized);
+	}
+#endif
+}
+
+
+//============================================================================
+void CFloatingDockContainer::restoreStateIncremental(const DockLayoutContainer& State)
+{
+	d->DockContainer->restoreStateIncremental(State);
+	onDockAreasAddedOrRemoved();
+}
+
 //============================================================================
 bool CFloatingDockContainer::hasTopLevelDockWidget() const
 {
@@ -1209,11 +1235,11 @@ void CFloatingDockContainer::moveEvent(QMoveEvent *event)
 	{
 	case DraggingMousePressed:
 		d->setState(DraggingFloatingWidget);
-		d->updateDropOverlays(QCursor::pos());
+		d->DropOverlayUpdates.schedule(QCursor::pos());
 		break;
 
 	case DraggingFloatingWidget:
-		d->updateDropOverlays(QCursor::pos());
+		d->DropOverlayUpdates.schedule(QCursor::pos());
 		// In OSX when hiding the DockAreaOverlay the application would set
 		// the main window as the active window for some reason. This fixes
 		// that by resetting the active window to the floating widget after
@@ -1306,7 +1332,7 @@ void CFloatingDockContainer::moveEvent(QMoveEvent* event)
 	if (!d->IsResizing && event->spontaneous())
 	{
 		d->DraggingState = DraggingFloatingWidget;
-		d->updateDropOverlays(QCursor::pos());
+		d->DropOverlayUpdates.schedule(QCursor::pos());
 	}
 	d->IsResizing = false;
 }
@@ -23,9 +23,17 @@
 #include "DockOverlay.h"
 #include "DockAreaTitleBar.h"
 #include "DockAreaTabBar.h"
+#include "DockDragUpdateScheduler.h"
+#include "DockDragSession.h"
+#include "DockTrace.h"
 
 namespace ads
 {
+/**
+ * Maximum width and height of the content preview pixmap. Larger content
+ * is rendered downscaled and the preview is stretched when painted.
+ */
+static const int MaxContentPreviewExtent = 512;
 
 /**
  * Private data class (pimpl)
@@ -41,7 +49,10 @@ struct FloatingDragPreviewPrivate
 	qreal WindowOpacity;
 	bool Hidden = false;
 	QPixmap ContentPreviewPixmap;
+	QSize ContentPreviewSize;///< size the preview pixmap is painted with
 	bool Canceled = false;
+	CDockDragUpdateScheduler DropOverlayUpdates;
+	CDockDragSession DragSession;
 
 
 	/**
@@ -62,6 +73,8 @@ struct FloatingDragPreviewPrivate
 	void cancelDragging()
 	{
 		Canceled = true;
+		DropOverlayUpdates.cancel();
+		DragSession.end();
 		emit _this->draggingCanceled();
 		DockManager->containerOverlay()->hideOverlay();
 		DockManager->dockAreaOverlay()->hideOverlay();
@@ -80,30 +93,17 @@ struct FloatingDragPreviewPrivate
 //============================================================================
 void FloatingDragPreviewPrivate::updateDropOverlays(const QPoint &GlobalPos)
 {
+	ADS_TRACE_SCOPE("FloatingDragPreviewPrivate::updateDropOverlays");
 	if (!_this->isVisible() || !DockManager)
 	{
 		return;
 	}
 
-	auto Containers = DockManager->dockContainers();
-	CDockContainerWidget *TopContainer = nullptr;
-	for (auto ContainerWidget : Containers)
+	if (!DragSession.isActive())
 	{
-		if (!ContainerWidget->isVisible())
-		{
-			continue;
-		}
-
-		QPoint MappedPos = ContainerWidget->mapFromGlobal(GlobalPos);
-		if (ContainerWidget->rect().contains(MappedPos))
-		{
-			if (!TopContainer || ContainerWidget->isInFrontOf(TopContainer))
-			{
-				TopContainer = ContainerWidget;
-			}
-		}
+		DragSession.begin(DockManager);
 	}
-
+	CDockContainerWidget *TopContainer = DragSession.containerAt(GlobalPos);
 	DropContainer = TopContainer;
 	auto ContainerOverlay = DockManager->containerOverlay();
 	auto DockAreaOverlay = DockManager->dockAreaOverlay();
@@ -124,7 +124,7 @@ void FloatingDragPreviewPrivate::updateDropOverlays(const QPoint &GlobalPos)
 	int VisibleDockAreas = TopContainer->visibleDockAreaCount();
 	ContainerOverlay->setAllowedAreas(
 	    VisibleDockAreas > 1 ? OuterDockAreas : AllDockAreas);
-	auto DockArea = TopContainer->dockAreaAt(GlobalPos);
+	auto DockArea = DragSession.dockAreaAt(TopContainer, GlobalPos);
 	if (DockArea && DockArea->isVisible() && VisibleDockAreas >= 0 && DockArea != ContentSourceArea)
 	{
 		DockAreaOverlay->enableDropPreview(true);
@@ -178,7 +178,11 @@ void FloatingDragPreviewPrivate::updateDropOverlays(const QPoint &GlobalPos)
 
 //============================================================================
 FloatingDragPreviewPrivate::FloatingDragPreviewPrivate(CFloatingDragPreview *_public) :
-	_this(_public)
+	_this(_public),
+	DropOverlayUpdates(_public, [this](const QPoint& GlobalPos)
+	{
+		updateDropOverlays(GlobalPos);
+	})
 {
 
 }
@@ -249,8 +253,13 @@ CFloatingDragPreview::CFloatingDragPreview(QWidget* Content, QWidget* parent) :
 	// operations
 	if (CDockManager::testConfigFlag(CDockManager::DragPreviewShowsContentPixmap))
 	{
-		d->ContentPreviewPixmap = QPixmap(Content->size());
-		Content->render(&d->ContentPreviewPixmap);
+		// Dock widgets supply a cached or application provided preview. The
+		// preview is downscaled to keep the drag start cheap for large content.
+		const QSize MaxSize(MaxContentPreviewExtent, MaxContentPreviewExtent);
+		CDockWidget* DockWidget = qobject_cast<CDockWidget*>(Content);
+		d->ContentPreviewSize = Content->size();
+		d->ContentPreviewPixmap = DockWidget ? DockWidget->previewPixmap(MaxSize)
+			: internal::createPreviewPixmap(Content, MaxSize);
 	}
 
 	connect(qApp, SIGNAL(applicationStateChanged(Qt::ApplicationState)),
@@ -299,7 +308,7 @@ void CFloatingDragPreview::moveFloating()
 	const QPoint moveToPos = QCursor::pos() - d->DragStartMousePosition
 	    - QPoint(BorderSize, 0);
 	move(moveToPos);
-	d->updateDropOverlays(QCursor::pos());
+	d->DropOverlayUpdates.schedule(QCursor::pos());
 }
 
 
@@ -321,6 +330,9 @@ void CFloatingDragPreview::startFloating(const QPoint &DragStartMousePos,
 void CFloatingDragPreview::finishDragging()
 {
 	ADS_PRINT("CFloatingDragPreview::finishDragging");
+	// The drop must be evaluated with the overlays of the latest position
+	d->DropOverlayUpdates.flush();
+	d->DragSession.end();
 	auto DockDropArea = d->DockManager->dockAreaOverlay()->visibleDropAreaUnderCursor();
 	auto ContainerDropArea = d->DockManager->containerOverlay()->visibleDropAreaUnderCursor();
 	if (!d->DropContainer)
@@ -384,7 +396,8 @@ void CFloatingDragPreview::paintEvent(QPaintEvent* event)
 	QPainter painter(this);
 	if (CDockManager::testConfigFlag(CDockManager::DragPreviewShowsContentPixmap))
 	{
-		painter.drawPixmap(QPoint(0, 0), d->ContentPreviewPixmap);
+		painter.setRenderHint(QPainter::SmoothPixmapTransform);
+		painter.drawPixmap(QRect(QPoint(0, 0), d->ContentPreviewSize), d->ContentPreviewPixmap);
 	}
 
 	// If we do not have a window frame then we paint a QRubberBand like
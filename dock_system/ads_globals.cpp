@@ -37,6 +37,7 @@
 #include "DockManager.h"
 #include "IconProvider.h"
 #include "ads_globals.h"
+#include "DockMetrics.h"
 
 
 namespace ads
@@ -127,6 +128,7 @@ void repolishStyle(QWidget* w, eRepolishChildOptions Options)
 	{
 		return;
 	}
+	CDockMetricScope Metric(StyleRepolishes);
 	w->style()->unpolish(w);
 	w->style()->polish(w);
 
@@ -144,6 +146,34 @@ void repolishStyle(QWidget* w, eRepolishChildOptions Options)
 	}
 }
 
+
+//============================================================================
+QPixmap createPreviewPixmap(QWidget* Widget, const QSize& MaxSize)
+{
+	const QSize WidgetSize = Widget->size();
+	if (WidgetSize.isEmpty())
+	{
+		return QPixmap();
+	}
+
+	QSize PixmapSize = WidgetSize;
+	if (PixmapSize.width() > MaxSize.width() || PixmapSize.height() > MaxSize.height())
+	{
+		PixmapSize.scale(MaxSize, Qt::KeepAspectRatio);
+	}
+
+	// Rendering into a scaled painter rasterizes only the pixels of the
+	// downscaled preview
+	QPixmap Pixmap(PixmapSize);
+	Pixmap.fill(Qt::transparent);
+	QPainter Painter(&Pixmap);
+	Painter.setRenderHint(QPainter::SmoothPixmapTransform);
+	Painter.scale(static_cast<qreal>(PixmapSize.width()) / WidgetSize.width(),
+		static_cast<qreal>(PixmapSize.height()) / WidgetSize.height());
+	Widget->render(&Painter);
+	return Pixmap;
+}
+
 } // namespace internal
 } // namespace ads
 
@@ -0,0 +1,464 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   ads_bench.cpp
+/// \date   16.10.2026
+/// \brief  Headless benchmark of the core dock manager operations
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QMainWindow>
+#include <QPointer>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include "DockManager.h"
+#include "DockWidget.h"
+#include "DockAreaWidget.h"
+#include "DockContainerWidget.h"
+#include "DockOverlay.h"
+#include "DockDragSession.h"
+#include "DockLayoutUpdateGuard.h"
+#include "DockTrace.h"
+#include "DockMetrics.h"
+
+using namespace ads;
+
+namespace
+{
+/**
+ * Number of dock widgets that are inserted as tabs into each dock area
+ */
+const int DockWidgetsPerArea = 4;
+
+/**
+ * Elapsed nanoseconds of each run and the metrics of all runs
+ */
+struct Measurement
+{
+	QVector<qint64> Samples;
+	DockMetricsSnapshot Metrics;
+
+	void addMetrics(const DockMetricsSnapshot& Delta)
+	{
+		for (int i = 0; i < DockMetricCount; ++i)
+		{
+			Metrics.Counts[i] += Delta.Counts[i];
+			Metrics.Nanoseconds[i] += Delta.Nanoseconds[i];
+		}
+	}
+};
+
+
+/**
+ * Collects the timing results of all operations
+ */
+struct BenchResults
+{
+	QJsonArray Results;
+
+	void add(const QString& Operation, int DockWidgets, const Measurement& Measured)
+	{
+		const auto& Samples = Measured.Samples;
+		qint64 Total = 0;
+		qint64 Min = std::numeric_limits<qint64>::max();
+		qint64 Max = 0;
+		for (auto Sample : Samples)
+		{
+			Total += Sample;
+			Min = std::min(Min, Sample);
+			Max = std::max(Max, Sample);
+		}
+
+		QJsonObject Result;
+		Result["operation"] = Operation;
+		Result["dock_widgets"] = DockWidgets;
+		Result["iterations"] = Samples.count();
+		Result["total_ms"] = Total / 1e6;
+		Result["mean_ms"] = Samples.isEmpty() ? 0.0 : Total / 1e6 / Samples.count();
+		Result["min_ms"] = Samples.isEmpty() ? 0.0 : Min / 1e6;
+		Result["max_ms"] = Max / 1e6;
+
+		// The raw samples allow a noise aware comparison with a baseline
+		QJsonArray SamplesMs;
+		for (auto Sample : Samples)
+		{
+			SamplesMs.append(Sample / 1e6);
+		}
+		Result["samples_ms"] = SamplesMs;
+
+		// The counters are deterministic - so they are reported per
+		// iteration to be comparable between runs
+		QJsonObject Metrics;
+		for (int i = 0; i < DockMetricCount; ++i)
+		{
+			auto Metric = static_cast<eDockMetric>(i);
+			Metrics[CDockMetrics::name(Metric)] = Samples.isEmpty() ? 0.0
+				: double(Measured.Metrics.count(Metric)) / Samples.count();
+		}
+		Result["metrics"] = Metrics;
+		Results.append(Result);
+	}
+};
+
+
+/**
+ * Runs the given function Iterations times and returns the elapsed
+ * nanoseconds and the metrics of each run. Pending events are processed
+ * after each run, so deferred relayouts are part of the measured time.
+ */
+Measurement measure(int Iterations, const std::function<void(int)>& Function)
+{
+	Measurement Result;
+	QElapsedTimer Timer;
+	for (int i = 0; i < Iterations; ++i)
+	{
+		auto Before = CDockManager::metrics();
+		Timer.start();
+		Function(i);
+		QApplication::processEvents();
+		Result.Samples.append(Timer.nsecsElapsed());
+		Result.addMetrics(CDockManager::metrics() - Before);
+	}
+	return Result;
+}
+
+
+/**
+ * Main window with a dock manager populated with DockWidgetCount dock widgets
+ */
+struct BenchWindow
+{
+	QMainWindow Window;
+	CDockManager* DockManager;
+	QList<CDockWidget*> DockWidgets;
+
+	BenchWindow()
+	{
+		DockManager = new CDockManager(&Window);
+		Window.resize(1600, 1000);
+		Window.show();
+		QApplication::processEvents();
+	}
+
+	/**
+	 * Builds a layout with one new dock area for every DockWidgetsPerArea
+	 * dock widgets. The new areas alternate between right and bottom of the
+	 * previous area.
+	 */
+	void populate(int DockWidgetCount)
+	{
+		CDockAreaWidget* DockArea = nullptr;
+		for (int i = 0; i < DockWidgetCount; ++i)
+		{
+			auto DockWidget = new CDockWidget(QString("View %1").arg(i), CDockWidget::VIEW_SETTING);
+			DockWidget->setObjectName(QString("view_%1").arg(i));
+			DockWidget->setWidget(new QLabel(DockWidget->windowTitle()));
+			DockWidgets.append(DockWidget);
+			if (DockArea && (i % DockWidgetsPerArea))
+			{
+				DockManager->addDockWidgetTabToArea(DockWidget, DockArea);
+			}
+			else
+			{
+				auto Area = ((i / DockWidgetsPerArea) % 2) ? BottomDockWidgetArea : RightDockWidgetArea;
+				DockArea = DockManager->addDockWidget(Area, DockWidget, DockArea);
+			}
+		}
+	}
+};
+
+
+/**
+ * Measures populating an empty dock manager. Every iteration needs a new
+ * window, so the window creation and the teardown of the populated
+ * manager are done outside of the measured time.
+ */
+Measurement measurePopulate(int DockWidgetCount, int Iterations, bool Transaction)
+{
+	Measurement Measured;
+	QElapsedTimer Timer;
+	for (int i = 0; i < Iterations; ++i)
+	{
+		BenchWindow Bench;
+		auto Before = CDockManager::metrics();
+		Timer.start();
+		{
+			std::unique_ptr<CDockLayoutUpdateGuard> Guard(Transaction
+				? new CDockLayoutUpdateGuard(Bench.DockManager) : nullptr);
+			Bench.populate(DockWidgetCount);
+		}
+		QApplication::processEvents();
+		Measured.Samples.append(Timer.nsecsElapsed());
+		Measured.addMetrics(CDockManager::metrics() - Before);
+	}
+	return Measured;
+}
+
+
+//============================================================================
+void benchLayoutConstruction(BenchResults& Results, int DockWidgetCount, int Iterations)
+{
+	Results.add("add_dock_widget", DockWidgetCount,
+		measurePopulate(DockWidgetCount, Iterations, false));
+	Results.add("add_dock_widget_transaction", DockWidgetCount,
+		measurePopulate(DockWidgetCount, Iterations, true));
+}
+
+
+//============================================================================
+void benchState(BenchResults& Results, int DockWidgetCount, int Iterations)
+{
+	BenchWindow Bench;
+	Bench.populate(DockWidgetCount);
+	QByteArray State;
+	Results.add("save_state", DockWidgetCount, measure(Iterations, [&](int)
+	{
+		State = Bench.DockManager->saveState();
+	}));
+
+	Results.add("restore_state", DockWidgetCount, measure(Iterations, [&](int)
+	{
+		Bench.DockManager->restoreState(State);
+	}));
+
+	// The second perspective has every second dock widget closed, so that
+	// switching really changes the layout
+	Bench.DockManager->addPerspective("all");
+	for (int i = 0; i < Bench.DockWidgets.count(); i += 2)
+	{
+		Bench.DockWidgets[i]->toggleView(false);
+	}
+	QApplication::processEvents();
+	Bench.DockManager->addPerspective("half");
+	Results.add("open_perspective", DockWidgetCount, measure(Iterations * 2, [&](int i)
+	{
+		Bench.DockManager->openPerspective((i % 2) ? "half" : "all");
+	}));
+}
+
+
+//============================================================================
+void benchTabSwitch(BenchResults& Results, int DockWidgetCount, int Iterations)
+{
+	BenchWindow Bench;
+	Bench.populate(DockWidgetCount);
+	auto DockAreas = Bench.DockManager->openedDockAreas();
+	Results.add("set_current_index", DockWidgetCount, measure(Iterations, [&](int i)
+	{
+		for (auto DockArea : DockAreas)
+		{
+			DockArea->setCurrentIndex((i + 1) % DockArea->dockWidgetsCount());
+		}
+	}));
+}
+
+
+//============================================================================
+void benchDragOverlays(BenchResults& Results, int DockWidgetCount, int Iterations)
+{
+	BenchWindow Bench;
+	Bench.populate(DockWidgetCount);
+	auto DockManager = Bench.DockManager;
+	auto ContainerOverlay = DockManager->containerOverlay();
+	auto DockAreaOverlay = DockManager->dockAreaOverlay();
+
+	// A diagonal drag across the dock manager with 100 mouse positions.
+	// Each position runs the hit tests and overlay updates that
+	// updateDropOverlays() runs for a mouse move.
+	const QRect Rect(DockManager->mapToGlobal(QPoint(0, 0)), DockManager->size());
+	const int Steps = 100;
+	Results.add("drag_overlay_update", DockWidgetCount, measure(Iterations, [&](int)
+	{
+		CDockDragSession Session;
+		Session.begin(DockManager);
+		for (int Step = 0; Step < Steps; ++Step)
+		{
+			QPoint GlobalPos(Rect.left() + Rect.width() * Step / Steps,
+				Rect.top() + Rect.height() * Step / Steps);
+			auto Container = Session.containerAt(GlobalPos);
+			if (!Container)
+			{
+				continue;
+			}
+			ContainerOverlay->setAllowedAreas(OuterDockAreas);
+			ContainerOverlay->showOverlay(Container);
+			auto DockArea = Session.dockAreaAt(Container, GlobalPos);
+			if (DockArea)
+			{
+				DockAreaOverlay->setAllowedAreas(DockArea->allowedAreas());
+				DockAreaOverlay->showOverlay(DockArea);
+			}
+			else
+			{
+				DockAreaOverlay->hideOverlay();
+			}
+		}
+		Session.end();
+		ContainerOverlay->hideOverlay();
+		DockAreaOverlay->hideOverlay();
+	}));
+}
+
+
+//============================================================================
+void benchRemoveDockArea(BenchResults& Results, int DockWidgetCount, int Iterations)
+{
+	Measurement Measured;
+	QElapsedTimer Timer;
+	for (int i = 0; i < Iterations; ++i)
+	{
+		BenchWindow Bench;
+		Bench.populate(DockWidgetCount);
+		QList<QPointer<CDockWidget>> DockWidgets;
+		for (auto DockWidget : Bench.DockWidgets)
+		{
+			DockWidgets.append(DockWidget);
+		}
+		auto Before = CDockManager::metrics();
+		Timer.start();
+		// Removing the last dock widget of an area removes the area
+		for (auto DockWidget : Bench.DockWidgets)
+		{
+			Bench.DockManager->removeDockWidget(DockWidget);
+		}
+		QApplication::processEvents();
+		Measured.Samples.append(Timer.nsecsElapsed());
+		Measured.addMetrics(CDockManager::metrics() - Before);
+
+		// Removed dock widgets that are no longer owned by a dock area
+		for (const auto& DockWidget : DockWidgets)
+		{
+			if (DockWidget && !DockWidget->parent())
+			{
+				delete DockWidget;
+			}
+		}
+	}
+	Results.add("remove_dock_area", DockWidgetCount, Measured);
+}
+} // namespace
+
+
+//============================================================================
+int main(int argc, char *argv[])
+{
+	// The benchmark runs on build agents without a display
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+	{
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+	QApplication App(argc, argv);
+	QApplication::setApplicationName("ads_bench");
+
+	QCommandLineParser Parser;
+	Parser.setApplicationDescription("Benchmark of the core dock manager operations");
+	Parser.addHelpOption();
+	QCommandLineOption SizesOption("sizes",
+		"Comma separated list of dock widget counts.", "list", "10,100,1000");
+	QCommandLineOption IterationsOption("iterations",
+		"Number of iterations of each operation.", "count", "5");
+	QCommandLineOption OutputOption("output",
+		"Write the JSON results to the given file instead of stdout.", "file");
+	Parser.addOption(SizesOption);
+	Parser.addOption(IterationsOption);
+	QCommandLineOption TraceOption("trace",
+		"Record the trace points and write them as Chrome trace JSON into "
+		"the given file. Requires a library built with ADS_ENABLE_TRACING.",
+		"file");
+	Parser.addOption(OutputOption);
+	Parser.addOption(TraceOption);
+	Parser.process(App);
+
+	if (Parser.isSet(TraceOption))
+	{
+		if (!ads::CDockTrace::isCompiledIn())
+		{
+			qWarning("The library has been built without trace points");
+		}
+		ads::CDockTrace::setEnabled(true);
+	}
+
+	const int Iterations = std::max(1, Parser.value(IterationsOption).toInt());
+	BenchResults Results;
+	for (const auto& SizeString : Parser.value(SizesOption).split(',', QString::SkipEmptyParts))
+	{
+		const int DockWidgetCount = SizeString.trimmed().toInt();
+		if (DockWidgetCount <= 0)
+		{
+			continue;
+		}
+
+		benchLayoutConstruction(Results, DockWidgetCount, Iterations);
+		benchState(Results, DockWidgetCount, Iterations);
+		benchTabSwitch(Results, DockWidgetCount, Iterations);
+		benchDragOverlays(Results, DockWidgetCount, Iterations);
+		benchRemoveDockArea(Results, DockWidgetCount, Iterations);
+	}
+
+	QJsonObject Root;
+	Root["benchmark"] = QString("ads_bench");
+	Root["qt_version"] = QString(qVersion());
+	Root["platform"] = QGuiApplication::platformName();
+	Root["iterations"] = Iterations;
+	Root["results"] = Results.Results;
+	const QByteArray Json = QJsonDocument(Root).toJson();
+
+	if (Parser.isSet(OutputOption))
+	{
+		QFile File(Parser.value(OutputOption));
+		if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qCritical("Cannot write %s", qPrintable(File.fileName()));
+			return 1;
+		}
+		File.write(Json);
+	}
+	else
+	{
+		QTextStream(stdout) << Json;
+	}
+
+	if (Parser.isSet(TraceOption)
+	 && !ads::CDockTrace::writeChromeTrace(Parser.value(TraceOption)))
+	{
+		qCritical("Cannot write %s", qPrintable(Parser.value(TraceOption)));
+		return 1;
+	}
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+// EOF ads_bench.cpp
@@ -0,0 +1,435 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   ads_bench_compare.cpp
+/// \date   16.10.2026
+/// \brief  Compares ads_bench results with a baseline
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QProcess>
+#include <QSet>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+/**
+ * Scale factor that turns the median absolute deviation into an estimate
+ * of the standard deviation for normal distributed samples
+ */
+const double MadScale = 1.4826;
+
+/**
+ * Exit code if the baseline does not exist. CTest reports the performance
+ * gate as skipped instead of failed for this code.
+ */
+const int SkipExitCode = 77;
+
+/**
+ * Pooled results of one operation at one layout size
+ */
+struct BenchEntry
+{
+	std::vector<double> SamplesMs;
+	QMap<QString, double> MetricSums;
+	int Runs = 0;
+
+	double metric(const QString& Name) const
+	{
+		return Runs ? MetricSums.value(Name) / Runs : 0.0;
+	}
+};
+
+/**
+ * Results are identified by operation name and number of dock widgets,
+ * e.g. "restore_state@500"
+ */
+using BenchResults = QMap<QString, BenchEntry>;
+
+
+//============================================================================
+double median(std::vector<double> Values)
+{
+	if (Values.empty())
+	{
+		return 0.0;
+	}
+
+	std::sort(Values.begin(), Values.end());
+	size_t Middle = Values.size() / 2;
+	return (Values.size() % 2) ? Values[Middle]
+		: (Values[Middle - 1] + Values[Middle]) / 2.0;
+}
+
+
+//============================================================================
+double medianAbsoluteDeviation(const std::vector<double>& Values, double Median)
+{
+	std::vector<double> Deviations;
+	Deviations.reserve(Values.size());
+	for (auto Value : Values)
+	{
+		Deviations.push_back(std::fabs(Value - Median));
+	}
+	return median(Deviations);
+}
+
+
+//============================================================================
+bool loadResults(const QString& FileName, BenchResults& Results)
+{
+	QFile File(FileName);
+	if (!File.open(QIODevice::ReadOnly))
+	{
+		qCritical("Cannot read %s", qPrintable(FileName));
+		return false;
+	}
+
+	QJsonParseError Error;
+	auto Document = QJsonDocument::fromJson(File.readAll(), &Error);
+	if (Document.isNull() || !Document.isObject())
+	{
+		qCritical("%s: %s", qPrintable(FileName), qPrintable(Error.errorString()));
+		return false;
+	}
+
+	for (const auto& Value : Document.object()["results"].toArray())
+	{
+		auto Result = Value.toObject();
+		auto Key = QString("%1@%2").arg(Result["operation"].toString())
+			.arg(Result["dock_widgets"].toInt());
+		auto& Entry = Results[Key];
+		auto Samples = Result["samples_ms"].toArray();
+		if (Samples.isEmpty())
+		{
+			// Results without raw samples only provide the mean
+			Entry.SamplesMs.push_back(Result["mean_ms"].toDouble());
+		}
+		for (const auto& Sample : Samples)
+		{
+			Entry.SamplesMs.push_back(Sample.toDouble());
+		}
+
+		// A merged baseline stores the metric sums of all its runs
+		int Runs = std::max(1, Result["runs"].toInt());
+		auto Metrics = Result["metrics"].toObject();
+		for (auto it = Metrics.constBegin(); it != Metrics.constEnd(); ++it)
+		{
+			Entry.MetricSums[it.key()] += it.value().toDouble() * Runs;
+		}
+		Entry.Runs += Runs;
+	}
+	return true;
+}
+
+
+//============================================================================
+bool writeBaseline(const QString& FileName, const BenchResults& Results, int Runs)
+{
+	QJsonArray Array;
+	for (auto it = Results.constBegin(); it != Results.constEnd(); ++it)
+	{
+		auto Separator = it.key().lastIndexOf('@');
+		QJsonObject Result;
+		Result["operation"] = it.key().left(Separator);
+		Result["dock_widgets"] = it.key().mid(Separator + 1).toInt();
+		Result["runs"] = it.value().Runs;
+		Result["mean_ms"] = median(it.value().SamplesMs);
+		QJsonArray Samples;
+		for (auto Sample : it.value().SamplesMs)
+		{
+			Samples.append(Sample);
+		}
+		Result["samples_ms"] = Samples;
+		QJsonObject Metrics;
+		for (const auto& Name : it.value().MetricSums.keys())
+		{
+			Metrics[Name] = it.value().metric(Name);
+		}
+		Result["metrics"] = Metrics;
+		Array.append(Result);
+	}
+
+	QJsonObject Root;
+	Root["benchmark"] = QString("ads_bench");
+	Root["baseline_runs"] = Runs;
+	Root["results"] = Array;
+	QFile File(FileName);
+	if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qCritical("Cannot write %s", qPrintable(FileName));
+		return false;
+	}
+	File.write(QJsonDocument(Root).toJson());
+	return true;
+}
+
+
+//============================================================================
+bool runBench(const QString& Bench, const QStringList& BenchArgs, int Runs,
+	const QString& OutputDir, QStringList& Files)
+{
+	QDir Dir(OutputDir);
+	if (!Dir.mkpath("."))
+	{
+		qCritical("Cannot create %s", qPrintable(OutputDir));
+		return false;
+	}
+
+	for (int Run = 1; Run <= Runs; ++Run)
+	{
+		auto FileName = Dir.filePath(QString("ads_bench_run%1.json").arg(Run));
+		qInfo("ads_bench run %d/%d", Run, Runs);
+		QProcess Process;
+		Process.setProcessChannelMode(QProcess::ForwardedChannels);
+		Process.start(Bench, QStringList(BenchArgs) << "--output" << FileName);
+		if (!Process.waitForFinished(-1) || Process.exitStatus() != QProcess::NormalExit
+		 || Process.exitCode() != 0)
+		{
+			qCritical("ads_bench run %d failed: %s", Run, qPrintable(Process.errorString()));
+			return false;
+		}
+		Files.append(FileName);
+	}
+	return true;
+}
+} // namespace
+
+
+//============================================================================
+int main(int argc, char *argv[])
+{
+	QCoreApplication App(argc, argv);
+	QCoreApplication::setApplicationName("ads_bench_compare");
+
+	QCommandLineParser Parser;
+	Parser.setApplicationDescription("Compares the results of one or more ads_bench "
+		"runs with a baseline. The samples of all runs are pooled and compared by "
+		"median. A difference counts as regression only if it exceeds the relative "
+		"tolerance, the noise threshold derived from the median absolute deviation "
+		"and the absolute minimum. With --bench the runs are recorded first. "
+		"A missing baseline exits with code 77.");
+	Parser.addHelpOption();
+	Parser.addPositionalArgument("baseline", "Baseline JSON file. Omitted with --write-baseline.");
+	Parser.addPositionalArgument("runs", "ads_bench JSON files of repeated runs.", "runs...");
+	QCommandLineOption ToleranceOption("tolerance",
+		"Allowed relative slowdown of the median.", "ratio", "0.25");
+	QCommandLineOption MadFactorOption("mad-factor",
+		"Noise threshold in scaled median absolute deviations.", "factor", "3");
+	QCommandLineOption MinDeltaOption("min-delta-ms",
+		"Slowdowns below this absolute value are ignored.", "ms", "0.05");
+	QCommandLineOption GateOption("gate",
+		"Comma separated operation@dock_widgets entries that fail the comparison "
+		"if they regress. All entries are gated by default.", "list");
+	QCommandLineOption MetricsToleranceOption("metrics-tolerance",
+		"Allowed relative increase of the metric counters.", "ratio", "0.1");
+	QCommandLineOption FailOnMetricsOption("fail-on-metrics",
+		"Fail if a metric counter of a gated entry increases beyond tolerance.");
+	QCommandLineOption WriteBaselineOption("write-baseline",
+		"Merge the given runs into a new baseline file instead of comparing.", "file");
+	QCommandLineOption BenchOption("bench",
+		"Run the given ads_bench executable and append its results to the runs.", "executable");
+	QCommandLineOption RunsOption("runs",
+		"Number of ads_bench runs with --bench.", "count", "3");
+	QCommandLineOption BenchArgsOption("bench-args",
+		"Space separated additional ads_bench arguments.", "args");
+	QCommandLineOption OutputDirOption("output-dir",
+		"Directory for the results of the ads_bench runs.", "dir", ".");
+	Parser.addOption(ToleranceOption);
+	Parser.addOption(MadFactorOption);
+	Parser.addOption(MinDeltaOption);
+	Parser.addOption(GateOption);
+	Parser.addOption(MetricsToleranceOption);
+	Parser.addOption(FailOnMetricsOption);
+	Parser.addOption(WriteBaselineOption);
+	Parser.addOption(BenchOption);
+	Parser.addOption(RunsOption);
+	Parser.addOption(BenchArgsOption);
+	Parser.addOption(OutputDirOption);
+	Parser.process(App);
+
+	auto Files = Parser.positionalArguments();
+	const bool WriteBaseline = Parser.isSet(WriteBaselineOption);
+	if (!WriteBaseline && !Files.isEmpty() && !QFileInfo::exists(Files.first()))
+	{
+		qWarning("No performance baseline at %s - comparison skipped. Record one "
+			"with the ads_perf_baseline target on the reference machine.",
+			qPrintable(Files.first()));
+		return SkipExitCode;
+	}
+
+	if (Parser.isSet(BenchOption) && !runBench(Parser.value(BenchOption),
+		Parser.value(BenchArgsOption).split(' ', QString::SkipEmptyParts),
+		Parser.value(RunsOption).toInt(), Parser.value(OutputDirOption), Files))
+	{
+		return 1;
+	}
+
+	if (WriteBaseline)
+	{
+		BenchResults Runs;
+		for (const auto& FileName : Files)
+		{
+			if (!loadResults(FileName, Runs))
+			{
+				return 1;
+			}
+		}
+		if (Runs.isEmpty())
+		{
+			Parser.showHelp(1);
+		}
+		return writeBaseline(Parser.value(WriteBaselineOption), Runs, Files.count()) ? 0 : 1;
+	}
+
+	if (Files.count() < 2)
+	{
+		Parser.showHelp(1);
+	}
+
+	BenchResults Baseline;
+	BenchResults Current;
+	if (!loadResults(Files.takeFirst(), Baseline))
+	{
+		return 1;
+	}
+	for (const auto& FileName : Files)
+	{
+		if (!loadResults(FileName, Current))
+		{
+			return 1;
+		}
+	}
+
+	const double Tolerance = Parser.value(ToleranceOption).toDouble();
+	const double MadFactor = Parser.value(MadFactorOption).toDouble();
+	const double MinDelta = Parser.value(MinDeltaOption).toDouble();
+	const double MetricsTolerance = Parser.value(MetricsToleranceOption).toDouble();
+	QSet<QString> Gated;
+	for (const auto& Entry : Parser.value(GateOption).split(',', QString::SkipEmptyParts))
+	{
+		Gated.insert(Entry.trimmed());
+	}
+
+	QTextStream Out(stdout);
+	Out << QString("%1 %2 %3 %4 %5  %6\n").arg("benchmark", -32).arg("base ms", 10)
+		.arg("current ms", 10).arg("delta", 8).arg("limit ms", 10).arg("status");
+	int Failures = 0;
+	for (auto it = Baseline.constBegin(); it != Baseline.constEnd(); ++it)
+	{
+		const bool IsGated = Gated.isEmpty() || Gated.contains(it.key());
+		if (!Current.contains(it.key()))
+		{
+			Out << QString("%1 %2\n").arg(it.key(), -32).arg("missing in current run", 10);
+			Failures += (IsGated && !Gated.isEmpty()) ? 1 : 0;
+			continue;
+		}
+
+		const auto& Base = it.value();
+		const auto& Run = Current[it.key()];
+		double BaseMedian = median(Base.SamplesMs);
+		double RunMedian = median(Run.SamplesMs);
+		double Noise = MadScale * std::max(medianAbsoluteDeviation(Base.SamplesMs, BaseMedian),
+			medianAbsoluteDeviation(Run.SamplesMs, RunMedian));
+		double Limit = std::max({Tolerance * BaseMedian, MadFactor * Noise, MinDelta});
+		double Delta = RunMedian - BaseMedian;
+		QString Status = "ok";
+		if (Delta > Limit)
+		{
+			Status = IsGated ? "REGRESSION" : "slower";
+			Failures += IsGated ? 1 : 0;
+		}
+		else if (-Delta > Limit)
+		{
+			Status = "faster";
+		}
+
+		QStringList MetricChanges;
+		for (const auto& Name : Base.MetricSums.keys())
+		{
+			double BaseValue = Base.metric(Name);
+			double RunValue = Run.metric(Name);
+			if (RunValue > BaseValue * (1.0 + MetricsTolerance) + 0.5)
+			{
+				MetricChanges << QString("%1 %2 -> %3").arg(Name)
+					.arg(BaseValue, 0, 'g', 4).arg(RunValue, 0, 'g', 4);
+			}
+		}
+		if (!MetricChanges.isEmpty() && IsGated && Parser.isSet(FailOnMetricsOption)
+		 && Status != "REGRESSION")
+		{
+			Status = "METRICS";
+			++Failures;
+		}
+
+		double Percent = BaseMedian > 0 ? 100.0 * Delta / BaseMedian : 0.0;
+		Out << QString("%1 %2 %3 %4 %5  %6\n").arg(it.key(), -32)
+			.arg(BaseMedian, 10, 'f', 3).arg(RunMedian, 10, 'f', 3)
+			.arg(QString("%1%2%").arg(Percent >= 0 ? "+" : "").arg(Percent, 0, 'f', 1), 8)
+			.arg(Limit, 10, 'f', 3).arg(Status);
+		for (const auto& Change : MetricChanges)
+		{
+			Out << "    metric increased: " << Change << '\n';
+		}
+	}
+
+	for (auto it = Current.constBegin(); it != Current.constEnd(); ++it)
+	{
+		if (!Baseline.contains(it.key()))
+		{
+			Out << QString("%1 %2\n").arg(it.key(), -32).arg("not in baseline", 10);
+		}
+	}
+
+	// A gated entry that is missing in the baseline would otherwise pass
+	// silently, e.g. for a typo or a baseline recorded with other sizes
+	for (const auto& Entry : Gated)
+	{
+		if (!Baseline.contains(Entry))
+		{
+			Out << QString("%1 %2\n").arg(Entry, -32).arg("gated, but missing in baseline", 10);
+			++Failures;
+		}
+	}
+
+	Out << (Failures ? QString("%1 regression(s) found\n").arg(Failures)
+		: QString("no regressions\n"));
+	return Failures ? 1 : 0;
+}
+
+//---------------------------------------------------------------------------
+// EOF ads_bench_compare.cpp
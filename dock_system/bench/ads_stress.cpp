@@ -0,0 +1,798 @@
+/*******************************************************************************
+** Qt Advanced Docking System
+** Copyright (C) 2017 Uwe Kindler
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License as published by the Free Software Foundation; either
+** version 2.1 of the License, or (at your option) any later version.
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+** Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public
+** License along with this library; If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+//============================================================================
+/// \file   ads_stress.cpp
+/// \date   16.10.2026
+/// \brief  Randomized layout mutation stress harness
+//============================================================================
+
+
+//============================================================================
+//                                   INCLUDES
+//============================================================================
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QCursor>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QMainWindow>
+#include <QPointer>
+#include <QSet>
+#include <QSplitter>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "DockManager.h"
+#include "DockWidget.h"
+#include "DockAreaWidget.h"
+#include "DockAreaTitleBar.h"
+#include "DockContainerWidget.h"
+#include "DockOverlay.h"
+#include "FloatingDockContainer.h"
+
+using namespace ads;
+
+namespace
+{
+/**
+ * The randomly applied layout mutations
+ */
+enum eOperation
+{
+	AddDockWidget,
+	RemoveDockWidget,
+	ToggleView,
+	SetFloating,
+	DropWidget,
+	DropFloatingWidget,
+	CloseOtherAreas,
+	SaveRestoreState,
+	SwitchPerspective,
+	OperationCount
+};
+
+const char* const OperationNames[OperationCount] =
+{
+	"add_dock_widget",
+	"remove_dock_widget",
+	"toggle_view",
+	"set_floating",
+	"drop_widget",
+	"drop_floating_widget",
+	"close_other_areas",
+	"save_restore_state",
+	"switch_perspective"
+};
+
+/**
+ * Relative probability of each operation
+ */
+const int OperationWeights[OperationCount] = {12, 8, 20, 8, 16, 8, 3, 3, 4};
+
+/**
+ * Number of log2 latency buckets. Bucket i counts the samples below
+ * 2^i microseconds, the last bucket counts all slower samples.
+ */
+const int HistogramBuckets = 22;
+
+
+/**
+ * Gives the harness access to the protected drop functions and the root
+ * splitter of a dock container - the mouse driven drag code calls the same
+ * functions
+ */
+struct ContainerAccess : public CDockContainerWidget
+{
+	using CDockContainerWidget::dropWidget;
+	using CDockContainerWidget::dropFloatingWidget;
+	using CDockContainerWidget::rootSplitter;
+};
+
+
+/**
+ * Latency samples of one operation
+ */
+struct LatencyStats
+{
+	std::vector<qint64> Samples;
+	int Histogram[HistogramBuckets] = {};
+
+	void add(qint64 Nanoseconds)
+	{
+		Samples.push_back(Nanoseconds);
+		qint64 Microseconds = Nanoseconds / 1000;
+		int Bucket = 0;
+		while (Bucket < HistogramBuckets - 1 && Microseconds >= (qint64(1) << Bucket))
+		{
+			++Bucket;
+		}
+		++Histogram[Bucket];
+	}
+
+	QJsonObject toJson() const
+	{
+		QJsonObject Result;
+		Result["count"] = int(Samples.size());
+		if (Samples.empty())
+		{
+			return Result;
+		}
+
+		auto Sorted = Samples;
+		std::sort(Sorted.begin(), Sorted.end());
+		auto Percentile = [&Sorted](double p)
+		{
+			size_t Index = std::min(Sorted.size() - 1, size_t(p * Sorted.size()));
+			return Sorted[Index] / 1e6;
+		};
+		qint64 Total = 0;
+		for (auto Sample : Sorted)
+		{
+			Total += Sample;
+		}
+		Result["mean_ms"] = Total / 1e6 / Sorted.size();
+		Result["p50_ms"] = Percentile(0.5);
+		Result["p90_ms"] = Percentile(0.9);
+		Result["p99_ms"] = Percentile(0.99);
+		Result["max_ms"] = Sorted.back() / 1e6;
+
+		QJsonArray Buckets;
+		for (int i = 0; i < HistogramBuckets; ++i)
+		{
+			if (!Histogram[i])
+			{
+				continue;
+			}
+			QJsonObject Bucket;
+			Bucket["lt_us"] = (i < HistogramBuckets - 1) ? QJsonValue(double(qint64(1) << i))
+				: QJsonValue("inf");
+			Bucket["count"] = Histogram[i];
+			Buckets.append(Bucket);
+		}
+		Result["histogram"] = Buckets;
+		return Result;
+	}
+};
+
+
+/**
+ * Applies random layout mutations to a dock manager and checks the
+ * structural invariants after each mutation
+ */
+class StressRunner
+{
+public:
+	StressRunner(quint32 Seed, int InitialDockWidgets, int MaxDockWidgets)
+		: Engine(Seed),
+		  MaxDockWidgets(MaxDockWidgets)
+	{
+		// Without this flag the drop functions do nothing
+		CDockManager::setConfigFlag(CDockManager::DropToCenter, true);
+		DockManager = new CDockManager(&Window);
+		Window.resize(1600, 1000);
+		Window.show();
+		for (int i = 0; i < InitialDockWidgets; ++i)
+		{
+			addDockWidget(false);
+		}
+		flushEvents();
+	}
+
+	/**
+	 * Returns a random number in the range [0, Bound). The engine is used
+	 * directly because the standard distributions are implementation
+	 * defined and would break the reproducibility across platforms.
+	 */
+	int random(int Bound)
+	{
+		return Bound > 0 ? int(Engine() % quint32(Bound)) : 0;
+	}
+
+	eOperation randomOperation()
+	{
+		int Total = 0;
+		for (auto Weight : OperationWeights)
+		{
+			Total += Weight;
+		}
+		int Value = random(Total);
+		for (int i = 0; i < OperationCount; ++i)
+		{
+			Value -= OperationWeights[i];
+			if (Value < 0)
+			{
+				return static_cast<eOperation>(i);
+			}
+		}
+		return AddDockWidget;
+	}
+
+	/**
+	 * Applies the given operation and returns false, if there was no
+	 * suitable target for the operation
+	 */
+	bool apply(eOperation Operation)
+	{
+		switch (Operation)
+		{
+		case AddDockWidget: return addDockWidget(random(8) == 0);
+		case RemoveDockWidget: return removeDockWidget();
+		case ToggleView: return toggleView();
+		case SetFloating: return setFloating();
+		case DropWidget: return dropWidget();
+		case DropFloatingWidget: return dropFloatingWidget();
+		case CloseOtherAreas: return closeOtherAreas();
+		case SaveRestoreState: return saveRestoreState();
+		case SwitchPerspective: return switchPerspective();
+		default: return false;
+		}
+	}
+
+	/**
+	 * Processes pending events and deferred deletions, so the checks and
+	 * the measured latency include the deferred work
+	 */
+	void flushEvents()
+	{
+		QApplication::processEvents();
+		QApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+	}
+
+	/**
+	 * Returns the list of violated invariants
+	 */
+	QStringList checkInvariants();
+
+	/**
+	 * Returns and clears the errors that the operations detected
+	 * themselves, e.g. a failed restoreState()
+	 */
+	QStringList takeOperationErrors()
+	{
+		QStringList Errors;
+		Errors.swap(OperationErrors);
+		return Errors;
+	}
+
+	int dockWidgetCount() const {return DockManager->dockWidgetsMap().count();}
+	int floatingWidgetCount() const {return DockManager->floatingWidgets().count();}
+
+	int dockAreaCount() const
+	{
+		int Count = 0;
+		for (auto Container : DockManager->dockContainers())
+		{
+			Count += Container->dockAreaCount();
+		}
+		return Count;
+	}
+
+private:
+	QStringList checkContainer(CDockContainerWidget* Container);
+	bool addDockWidget(bool Floating);
+	bool removeDockWidget();
+	bool toggleView();
+	bool setFloating();
+	bool dropWidget();
+	bool dropFloatingWidget();
+	bool closeOtherAreas();
+	bool saveRestoreState();
+	bool switchPerspective();
+
+	template <class T>
+	T* pick(const QList<T*>& List)
+	{
+		return List.isEmpty() ? nullptr : List[random(List.count())];
+	}
+
+	/**
+	 * Returns all dock widgets that are placed in a dock area
+	 */
+	QList<CDockWidget*> dockedWidgets() const
+	{
+		QList<CDockWidget*> Result;
+		for (auto DockWidget : DockManager->dockWidgetsMap())
+		{
+			if (DockWidget->dockAreaWidget())
+			{
+				Result.append(DockWidget);
+			}
+		}
+		return Result;
+	}
+
+	DockWidgetArea randomArea(bool Center)
+	{
+		static const DockWidgetArea Areas[] = {LeftDockWidgetArea,
+			RightDockWidgetArea, TopDockWidgetArea, BottomDockWidgetArea,
+			CenterDockWidgetArea};
+		return Areas[random(Center ? 5 : 4)];
+	}
+
+	std::mt19937 Engine;
+	QStringList OperationErrors;
+	int MaxDockWidgets;
+	int NextDockWidgetId = 0;
+	QMainWindow Window;
+	CDockManager* DockManager;
+};
+
+
+//============================================================================
+bool StressRunner::addDockWidget(bool Floating)
+{
+	if (dockWidgetCount() >= MaxDockWidgets)
+	{
+		return false;
+	}
+
+	int Id = NextDockWidgetId++;
+	auto DockWidget = new CDockWidget(QString("Stress %1").arg(Id), CDockWidget::VIEW_SETTING);
+	DockWidget->setObjectName(QString("stress_%1").arg(Id));
+	DockWidget->setWidget(new QLabel(DockWidget->windowTitle()));
+	if (Floating)
+	{
+		DockManager->addDockWidgetFloating(DockWidget);
+		return true;
+	}
+
+	auto DockArea = pick(DockManager->openedDockAreas());
+	DockManager->addDockWidget(randomArea(DockArea != nullptr), DockWidget, DockArea);
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::removeDockWidget()
+{
+	auto DockWidget = pick(DockManager->dockWidgetsMap().values());
+	if (!DockWidget)
+	{
+		return false;
+	}
+
+	DockWidget->deleteDockWidget();
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::toggleView()
+{
+	auto DockWidget = pick(dockedWidgets());
+	if (!DockWidget)
+	{
+		return false;
+	}
+
+	DockWidget->toggleView(DockWidget->isClosed());
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::setFloating()
+{
+	QList<CDockWidget*> DockWidgets;
+	for (auto DockWidget : dockedWidgets())
+	{
+		if (!DockWidget->isClosed() && !DockWidget->isFloating())
+		{
+			DockWidgets.append(DockWidget);
+		}
+	}
+
+	auto DockWidget = pick(DockWidgets);
+	if (!DockWidget)
+	{
+		return false;
+	}
+
+	DockWidget->setFloating();
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::dropWidget()
+{
+	QList<CDockWidget*> DockWidgets;
+	for (auto DockWidget : dockedWidgets())
+	{
+		if (!DockWidget->isClosed())
+		{
+			DockWidgets.append(DockWidget);
+		}
+	}
+
+	auto DockWidget = pick(DockWidgets);
+	if (!DockWidget)
+	{
+		return false;
+	}
+
+	// Dropping onto the own area is not possible with the mouse
+	auto TargetAreas = DockManager->openedDockAreas();
+	TargetAreas.removeAll(DockWidget->dockAreaWidget());
+	auto TargetArea = random(4) ? pick(TargetAreas) : nullptr;
+	auto Drop = &ContainerAccess::dropWidget;
+	(DockManager->*Drop)(DockWidget, randomArea(TargetArea != nullptr), TargetArea);
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::dropFloatingWidget()
+{
+	QList<CFloatingDockContainer*> FloatingWidgets;
+	for (auto FloatingWidget : DockManager->floatingWidgets())
+	{
+		if (FloatingWidget->isVisible())
+		{
+			FloatingWidgets.append(FloatingWidget);
+		}
+	}
+
+	auto FloatingWidget = pick(FloatingWidgets);
+	auto TargetArea = pick(DockManager->openedDockAreas());
+	if (!FloatingWidget || !TargetArea)
+	{
+		return false;
+	}
+
+	// The drop position is taken from the cursor like for a mouse drop.
+	// Over the title bar of a dock area the drop goes into the area center.
+	auto TitleBar = TargetArea->titleBar();
+	QPoint GlobalPos = TitleBar->isVisible()
+		? TitleBar->mapToGlobal(TitleBar->rect().center())
+		: TargetArea->mapToGlobal(TargetArea->rect().center());
+	QCursor::setPos(GlobalPos);
+	auto Drop = &ContainerAccess::dropFloatingWidget;
+	(DockManager->*Drop)(FloatingWidget, GlobalPos);
+	DockManager->containerOverlay()->hideOverlay();
+	DockManager->dockAreaOverlay()->hideOverlay();
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::closeOtherAreas()
+{
+	auto DockArea = pick(DockManager->openedDockAreas());
+	if (!DockArea)
+	{
+		return false;
+	}
+
+	DockArea->closeOtherAreas();
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::saveRestoreState()
+{
+	// Restoring a state that has just been saved must never fail
+	if (!DockManager->restoreState(DockManager->saveState()))
+	{
+		OperationErrors << QString("restoreState() rejected the state returned by saveState()");
+	}
+	return true;
+}
+
+
+//============================================================================
+bool StressRunner::switchPerspective()
+{
+	auto Names = DockManager->perspectiveNames();
+	if (Names.count() < 4 && (Names.isEmpty() || random(2)))
+	{
+		DockManager->addPerspective(QString("perspective_%1").arg(Names.count()));
+		return true;
+	}
+
+	DockManager->openPerspective(Names[random(Names.count())]);
+	return true;
+}
+
+
+//============================================================================
+QStringList StressRunner::checkContainer(CDockContainerWidget* Container)
+{
+	QStringList Errors;
+	auto Name = Container->isFloating() ? QString("floating container")
+		: QString("dock manager");
+	auto RootSplitterFunction = &ContainerAccess::rootSplitter;
+	auto RootSplitter = (Container->*RootSplitterFunction)();
+	QList<CDockAreaWidget*> TreeAreas;
+	std::function<void(QSplitter*)> Walk = [&](QSplitter* Splitter)
+	{
+		if (Splitter != RootSplitter && !Splitter->count())
+		{
+			Errors << QString("%1: empty splitter in layout tree").arg(Name);
+		}
+
+		for (int i = 0; i < Splitter->count(); ++i)
+		{
+			auto Widget = Splitter->widget(i);
+			if (auto ChildSplitter = qobject_cast<QSplitter*>(Widget))
+			{
+				Walk(ChildSplitter);
+			}
+			else if (auto DockArea = qobject_cast<CDockAreaWidget*>(Widget))
+			{
+				TreeAreas.append(DockArea);
+			}
+			else
+			{
+				Errors << QString("%1: unexpected splitter child %2").arg(Name)
+					.arg(Widget->metaObject()->className());
+			}
+		}
+	};
+	if (RootSplitter)
+	{
+		Walk(RootSplitter);
+	}
+
+	QList<CDockAreaWidget*> ListAreas;
+	for (int i = 0; i < Container->dockAreaCount(); ++i)
+	{
+		ListAreas.append(Container->dockArea(i));
+	}
+	if (TreeAreas.toSet().count() != TreeAreas.count())
+	{
+		Errors << QString("%1: dock area appears twice in layout tree").arg(Name);
+	}
+	if (TreeAreas.toSet() != ListAreas.toSet() || TreeAreas.count() != ListAreas.count())
+	{
+		Errors << QString("%1: DockAreas list (%2) does not match layout tree (%3)")
+			.arg(Name).arg(ListAreas.count()).arg(TreeAreas.count());
+	}
+
+	int VisibleAreas = 0;
+	for (auto DockArea : ListAreas)
+	{
+		if (!DockArea->isHidden())
+		{
+			++VisibleAreas;
+		}
+
+		int OpenDockWidgets = 0;
+		for (auto DockWidget : DockArea->dockWidgets())
+		{
+			if (!DockWidget->isClosed())
+			{
+				++OpenDockWidgets;
+			}
+			if (DockWidget->dockAreaWidget() != DockArea)
+			{
+				Errors << QString("%1: dock widget %2 has wrong dock area").arg(Name)
+					.arg(DockWidget->objectName());
+			}
+		}
+		if (DockArea->openDockWidgetsCount() != OpenDockWidgets)
+		{
+			Errors << QString("%1: dock area reports %2 open dock widgets instead of %3")
+				.arg(Name).arg(DockArea->openDockWidgetsCount()).arg(OpenDockWidgets);
+		}
+		if (!OpenDockWidgets && !DockArea->isHidden())
+		{
+			Errors << QString("%1: dock area without open dock widgets is visible").arg(Name);
+		}
+	}
+
+	if (Container->visibleDockAreaCount() != VisibleAreas)
+	{
+		Errors << QString("%1: visibleDockAreaCount() is %2 instead of %3").arg(Name)
+			.arg(Container->visibleDockAreaCount()).arg(VisibleAreas);
+	}
+	if (Container->openedDockAreas().count() != VisibleAreas)
+	{
+		Errors << QString("%1: openedDockAreas() has %2 areas instead of %3").arg(Name)
+			.arg(Container->openedDockAreas().count()).arg(VisibleAreas);
+	}
+	if (Container->isFloating() && ListAreas.isEmpty())
+	{
+		Errors << QString("%1: empty floating container still exists").arg(Name);
+	}
+	return Errors;
+}
+
+
+//============================================================================
+QStringList StressRunner::checkInvariants()
+{
+	QStringList Errors;
+	for (auto Container : DockManager->dockContainers())
+	{
+		Errors += checkContainer(Container);
+	}
+
+	for (auto DockWidget : DockManager->dockWidgetsMap())
+	{
+		auto DockArea = DockWidget->dockAreaWidget();
+		if (DockArea && !DockArea->dockWidgets().contains(DockWidget))
+		{
+			Errors << QString("dock widget %1 is not in its dock area")
+				.arg(DockWidget->objectName());
+		}
+	}
+	return Errors;
+}
+} // namespace
+
+
+//============================================================================
+int main(int argc, char *argv[])
+{
+	// The harness runs on build agents without a display
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+	{
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+	QApplication App(argc, argv);
+	QApplication::setApplicationName("ads_stress");
+
+	QCommandLineParser Parser;
+	Parser.setApplicationDescription("Randomized layout mutation stress harness. "
+		"Runs with the same seed apply the same sequence of mutations.");
+	Parser.addHelpOption();
+	QCommandLineOption SeedOption("seed",
+		"Seed of the random operation sequence.", "seed", "1");
+	QCommandLineOption OperationsOption("operations",
+		"Number of random operations.", "count", "10000");
+	QCommandLineOption WidgetsOption("widgets",
+		"Number of dock widgets of the initial layout.", "count", "200");
+	QCommandLineOption MaxWidgetsOption("max-widgets",
+		"Maximum number of dock widgets.", "count", "400");
+	QCommandLineOption CheckIntervalOption("check-interval",
+		"Check the invariants after every n-th operation.", "n", "1");
+	QCommandLineOption WindowOption("window",
+		"Number of operations per latency window of the session report.", "n", "1000");
+	QCommandLineOption KeepGoingOption("keep-going",
+		"Continue after an invariant violation.");
+	QCommandLineOption VerboseOption("verbose",
+		"Print every operation to stderr.");
+	QCommandLineOption OutputOption("output",
+		"Write the JSON results to the given file instead of stdout.", "file");
+	Parser.addOption(SeedOption);
+	Parser.addOption(OperationsOption);
+	Parser.addOption(WidgetsOption);
+	Parser.addOption(MaxWidgetsOption);
+	Parser.addOption(CheckIntervalOption);
+	Parser.addOption(WindowOption);
+	Parser.addOption(KeepGoingOption);
+	Parser.addOption(VerboseOption);
+	Parser.addOption(OutputOption);
+	Parser.process(App);
+
+	const quint32 Seed = Parser.value(SeedOption).toUInt();
+	const int Operations = std::max(0, Parser.value(OperationsOption).toInt());
+	const int CheckInterval = std::max(1, Parser.value(CheckIntervalOption).toInt());
+	const int WindowSize = std::max(1, Parser.value(WindowOption).toInt());
+	const bool Verbose = Parser.isSet(VerboseOption);
+	StressRunner Runner(Seed, Parser.value(WidgetsOption).toInt(),
+		std::max(1, Parser.value(MaxWidgetsOption).toInt()));
+
+	LatencyStats Stats[OperationCount];
+	QJsonArray Windows;
+	QJsonArray Violations;
+	LatencyStats SessionWindow;
+	QElapsedTimer Timer;
+	int Executed = 0;
+	for (int i = 0; i < Operations; ++i)
+	{
+		auto Operation = Runner.randomOperation();
+		if (Verbose)
+		{
+			QTextStream(stderr) << i << ' ' << OperationNames[Operation] << '\n';
+		}
+
+		Timer.start();
+		bool Applied = Runner.apply(Operation);
+		Runner.flushEvents();
+		qint64 Elapsed = Timer.nsecsElapsed();
+		++Executed;
+		if (Applied)
+		{
+			Stats[Operation].add(Elapsed);
+			SessionWindow.add(Elapsed);
+		}
+
+		if ((i + 1) % WindowSize == 0)
+		{
+			auto Entry = SessionWindow.toJson();
+			Entry.remove("histogram");
+			Entry["operations"] = i + 1;
+			Entry["dock_widgets"] = Runner.dockWidgetCount();
+			Entry["dock_areas"] = Runner.dockAreaCount();
+			Entry["floating_widgets"] = Runner.floatingWidgetCount();
+			Windows.append(Entry);
+			SessionWindow = LatencyStats();
+		}
+
+		auto Errors = Runner.takeOperationErrors();
+		if ((i + 1) % CheckInterval == 0)
+		{
+			Errors += Runner.checkInvariants();
+		}
+		for (const auto& Error : Errors)
+		{
+			QTextStream(stderr) << "seed " << Seed << " operation " << i << " ("
+				<< OperationNames[Operation] << "): " << Error << '\n';
+			QJsonObject Violation;
+			Violation["index"] = i;
+			Violation["operation"] = QString(OperationNames[Operation]);
+			Violation["message"] = Error;
+			Violations.append(Violation);
+		}
+		if (!Errors.isEmpty() && !Parser.isSet(KeepGoingOption))
+		{
+			break;
+		}
+	}
+
+	QJsonArray Results;
+	for (int i = 0; i < OperationCount; ++i)
+	{
+		auto Result = Stats[i].toJson();
+		Result["operation"] = QString(OperationNames[i]);
+		Results.append(Result);
+	}
+
+	QJsonObject Root;
+	Root["benchmark"] = QString("ads_stress");
+	Root["qt_version"] = QString(qVersion());
+	Root["platform"] = QGuiApplication::platformName();
+	Root["seed"] = double(Seed);
+	Root["operations"] = Executed;
+	Root["results"] = Results;
+	Root["windows"] = Windows;
+	Root["violations"] = Violations;
+	const QByteArray Json = QJsonDocument(Root).toJson();
+
+	if (Parser.isSet(OutputOption))
+	{
+		QFile File(Parser.value(OutputOption));
+		if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			qCritical("Cannot write %s", qPrintable(File.fileName()));
+			return 1;
+		}
+		File.write(Json);
+	}
+	else
+	{
+		QTextStream(stdout) << Json;
+	}
+	return Violations.isEmpty() ? 0 : 2;
+}
+
+//---------------------------------------------------------------------------
+// EOF ads_stress.cpp
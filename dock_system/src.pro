@@ -15,6 +15,9 @@ adsBuildStatic {
 	CONFIG += staticlib
     DEFINES += ADS_STATIC
 }
+adsTrace {
+    DEFINES += ADS_TRACE_ENABLED
+}
 
 windows {
 	# MinGW
@@ -46,7 +49,15 @@ HEADERS += \
     ElidingLabel.h \
     IconProvider.h \
     DockComponentsFactory.h  \
-    DockFocusController.h
+    DockFocusController.h \
+    main_title_bar.hpp \
+    DockStateSerializer.h \
+    DockPersistenceJob.h \
+    DockLayoutUpdateGuard.h \
+    DockDragUpdateScheduler.h \
+    DockDragSession.h \
+    DockTrace.h \
+    DockMetrics.h
 
 
 SOURCES += \
@@ -66,7 +77,14 @@ SOURCES += \
     ElidingLabel.cpp \
     IconProvider.cpp \
     DockComponentsFactory.cpp \
-    DockFocusController.cpp
+    DockFocusController.cpp \
+    main_title_bar.cpp \
+    DockStateSerializer.cpp \
+    DockPersistenceJob.cpp \
+    DockDragUpdateScheduler.cpp \
+    DockDragSession.cpp \
+    DockTrace.cpp \
+    DockMetrics.cpp
 
 
 unix {